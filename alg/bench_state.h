@@ -0,0 +1,310 @@
+#ifndef TENACITAS_LIB_TEST_ALG_BENCH_STATE_H
+#define TENACITAS_LIB_TEST_ALG_BENCH_STATE_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <tenacitas.lib.program/alg/options.h>
+#include <tenacitas.lib.test/alg/internal/tsc.h>
+#include <tenacitas.lib.test/alg/tune.h>
+
+namespace tenacitas::lib::test::alg {
+
+/// \brief How the value accumulated in a counter of a benchmark is
+/// normalized when reported
+enum class counter_rate : std::uint8_t {
+  /// \brief Divided by the measured seconds
+  per_second,
+  /// \brief Divided by the number of iterations
+  per_iteration,
+  /// \brief Divided by the measured seconds and by the number of threads
+  per_thread,
+  /// \brief Reported as accumulated
+  total
+};
+
+/// \brief Named value accumulated by a benchmark, through
+/// \p bench_state::add_counter
+struct bench_counter {
+  const char *name{nullptr};
+  double value{0};
+  counter_rate rate{counter_rate::per_second};
+};
+
+/// \brief Maximum number of named counters of a benchmark
+static constexpr std::size_t max_bench_counters{8};
+
+/// \brief State of a benchmark iteration, passed to benchmark classes that
+/// implement
+///
+/// \code
+/// void operator()(test::alg::bench_state &)
+/// \endcode
+///
+/// \details The time of an iteration is the sum of the intervals where timing
+/// is not paused, accumulated in time stamp counter ticks, so pausing and
+/// resuming costs two counter reads.
+///
+/// Input that must be fresh in every iteration can also be prepared in
+/// batches, out of the measured region, if the benchmark class implements
+///
+/// \code
+/// static constexpr std::size_t batch_size{<n>};
+///
+/// void setup(test::alg::bench_state &)
+/// \endcode
+///
+/// \p setup is called before every \p batch_size iterations, and the
+/// iteration uses the input at \p batch_index().
+///
+/// The amount of work done can be reported with \p add_bytes, \p add_items
+/// and \p add_counter, and tester prints it as rates, like bytes per second.
+/// Values added during the warm up iterations are discarded.
+///
+/// \code
+/// struct bench_sort {
+///   static constexpr std::size_t batch_size{64};
+///
+///   void setup(test::alg::bench_state &) {
+///     for (std::vector<int> &_input : m_inputs) {
+///       std::shuffle(_input.begin(), _input.end(), m_engine);
+///     }
+///   }
+///
+///   void operator()(test::alg::bench_state &p_state) {
+///     std::vector<int> &_input{m_inputs[p_state.batch_index()]};
+///     std::sort(_input.begin(), _input.end());
+///   }
+///
+///   static std::string desc() { return "sorts shuffled vectors"; }
+///
+///   std::array<std::vector<int>, batch_size> m_inputs;
+///   std::mt19937 m_engine;
+/// };
+/// \endcode
+struct bench_state {
+  bench_state(const program::alg::options &p_options,
+              std::size_t p_batch_size)
+      : m_options(p_options), m_batch_size(p_batch_size) {}
+
+  bench_state() = delete;
+  bench_state(const bench_state &) = delete;
+  bench_state &operator=(const bench_state &) = delete;
+
+  /// \brief Stops counting time, for example, to prepare the input of the rest
+  /// of the iteration
+  void pause_timing() {
+    if (m_running) {
+      m_ticks += m_now() - m_start;
+      m_running = false;
+    }
+  }
+
+  /// \brief Starts counting time again
+  void resume_timing() {
+    if (!m_running) {
+      m_running = true;
+      m_start = m_now();
+    }
+  }
+
+  /// \brief Adds to the number of bytes processed, reported per second
+  void add_bytes(std::uint64_t p_bytes) { m_bytes += p_bytes; }
+
+  /// \brief Adds to the number of items processed, reported per second
+  void add_items(std::uint64_t p_items) { m_items += p_items; }
+
+  /// \brief Adds to a named counter
+  ///
+  /// \param p_name must remain valid until the benchmark finishes, like a
+  /// string literal
+  ///
+  /// \param p_value added to the counter
+  ///
+  /// \param p_rate how the accumulated value is reported; the first call
+  /// for a name defines it
+  ///
+  /// \throw std::length_error if more than \p max_bench_counters names are
+  /// used
+  void add_counter(const char *p_name, double p_value,
+                   counter_rate p_rate = counter_rate::per_second) {
+    for (std::size_t _i = 0; _i < m_num_counters; ++_i) {
+      if ((m_counters[_i].name == p_name) ||
+          (std::strcmp(m_counters[_i].name, p_name) == 0)) {
+        m_counters[_i].value += p_value;
+        return;
+      }
+    }
+    if (m_num_counters == max_bench_counters) {
+      throw std::length_error("too many counters in benchmark");
+    }
+    m_counters[m_num_counters++] = {p_name, p_value, p_rate};
+  }
+
+  /// \brief Informs how many threads the benchmark uses, for
+  /// \p counter_rate::per_thread counters; default is 1
+  void set_threads(std::size_t p_threads) {
+    m_threads = (p_threads == 0 ? 1 : p_threads);
+  }
+
+  /// \brief Options passed to the program
+  const program::alg::options &options() const { return m_options; }
+
+  /// \brief Value of a parameter of a benchmark executed with 'run_tune', in
+  /// the configuration being measured
+  ///
+  /// \throw std::logic_error if the benchmark is not executed with 'run_tune'
+  ///
+  /// \throw std::out_of_range if there is no parameter named \p p_name
+  std::int64_t param(std::string_view p_name) const {
+    if (m_tune_config == nullptr) {
+      throw std::logic_error("benchmark has no tune parameters");
+    }
+    return m_tune_config->value(p_name);
+  }
+
+  /// \brief Index of the current iteration, starting at 0 for the first
+  /// measured iteration
+  std::size_t iteration() const { return m_iteration; }
+
+  /// \brief Number of iterations that share an input prepared by 'setup'
+  std::size_t batch_size() const { return m_batch_size; }
+
+  /// \brief Index of the input, prepared by 'setup', that the current
+  /// iteration must use
+  std::size_t batch_index() const { return m_iteration % m_batch_size; }
+
+protected:
+  const program::alg::options &m_options;
+  std::size_t m_batch_size;
+  std::size_t m_iteration{0};
+  std::uint64_t m_start{0};
+  std::uint64_t m_ticks{0};
+  bool m_running{false};
+  std::uint64_t m_bytes{0};
+  std::uint64_t m_items{0};
+  std::size_t m_threads{1};
+  std::array<bench_counter, max_bench_counters> m_counters;
+  std::size_t m_num_counters{0};
+  const tune_config *m_tune_config{nullptr};
+  /// \brief Clock of the timer policy of the tester
+  std::uint64_t (*m_now)(){&internal::tsc};
+};
+
+namespace internal {
+
+/// \brief Gives tester access to the timing of a \p bench_state
+///
+/// \tparam t_timer is the timer policy of the tester, like
+/// tenacitas::lib::test::alg::tsc_timer
+template <typename t_timer> struct bench_state_driver : public bench_state {
+  bench_state_driver(const program::alg::options &p_options,
+                     std::size_t p_batch_size)
+      : bench_state(p_options, p_batch_size) {
+    m_now = &t_timer::now;
+  }
+
+  void set_iteration(std::size_t p_iteration) { m_iteration = p_iteration; }
+
+  void set_tune_config(const tune_config *p_config) {
+    m_tune_config = p_config;
+  }
+
+  void start() {
+    m_ticks = 0;
+    m_running = true;
+    m_start = t_timer::now();
+  }
+
+  /// \return the nanoseconds measured since \p start
+  double stop() {
+    if (m_running) {
+      m_ticks += t_timer::now() - m_start;
+      m_running = false;
+    }
+    return static_cast<double>(m_ticks) / t_timer::ticks_per_ns();
+  }
+
+  /// \brief Discards the values added to the counters
+  void reset_counters() {
+    m_bytes = 0;
+    m_items = 0;
+    for (std::size_t _i = 0; _i < m_num_counters; ++_i) {
+      m_counters[_i].value = 0;
+    }
+  }
+
+  std::uint64_t bytes() const { return m_bytes; }
+  std::uint64_t items() const { return m_items; }
+  std::size_t threads() const { return m_threads; }
+
+  template <typename t_visitor> void for_each_counter(t_visitor &&p_visitor) {
+    for (std::size_t _i = 0; _i < m_num_counters; ++_i) {
+      p_visitor(m_counters[_i]);
+    }
+  }
+};
+
+/// \brief Informs if a benchmark class implements 'void setup(bench_state &)'
+template <typename t_bench_class, typename = void>
+struct bench_has_setup : std::false_type {};
+
+template <typename t_bench_class>
+struct bench_has_setup<t_bench_class,
+                       std::void_t<decltype(std::declval<t_bench_class &>().setup(
+                           std::declval<bench_state &>()))>>
+    : std::true_type {};
+
+/// \brief 't_bench_class::batch_size', if it is defined, or 1
+template <typename t_bench_class, typename = void> struct bench_batch_size {
+  static constexpr std::size_t value{1};
+};
+
+template <typename t_bench_class>
+struct bench_batch_size<t_bench_class,
+                        std::void_t<decltype(t_bench_class::batch_size)>> {
+  static constexpr std::size_t value{t_bench_class::batch_size};
+  static_assert(value > 0, "'batch_size' must be greater than 0");
+};
+
+/// \brief Executes one iteration of a benchmark, passing the state if the
+/// benchmark class accepts it, or the program options otherwise
+template <typename t_bench_class>
+void bench_iteration(t_bench_class &p_bench, bench_state &p_state) {
+  if constexpr (std::is_invocable_v<t_bench_class &, bench_state &>) {
+    p_bench(p_state);
+  } else {
+    p_bench(p_state.options());
+  }
+}
+
+/// \brief Executes one measured iteration of the implementation at \p t_idx
+/// of a benchmark family
+///
+/// \return the nanoseconds measured
+template <std::size_t t_idx, typename t_family, typename t_impls,
+          typename t_driver>
+double family_iteration(t_family &p_family, t_impls &p_impls,
+                        t_driver &p_state) {
+  p_state.start();
+  p_family(std::get<t_idx>(p_impls), static_cast<bench_state &>(p_state));
+  return p_state.stop();
+}
+
+} // namespace internal
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
@@ -0,0 +1,327 @@
+#ifndef TENACITAS_LIB_TEST_ALG_CHECK_H
+#define TENACITAS_LIB_TEST_ALG_CHECK_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/// \brief Checks an expression, inside the 'operator()' of a test, which
+/// returns 'false' if the expression is false
+///
+/// \details A comparison, like 'check_that(_map.size() == 3)', is decomposed,
+/// so the values of both sides are printed to 'std::cerr' when it fails, with
+/// the file and line of the check. The values are formatted only when the
+/// check fails; when it passes, the cost is the comparison, a branch, and
+/// the increment of a thread local counter of checks.
+///
+/// The comparisons decomposed are '==', '!=', '<', '<=', '>' and '>='; other
+/// expressions, like 'a && b', must be between parenthesis, and only their
+/// result is printed.
+///
+/// \code
+/// struct test_sort {
+///   bool operator()(const program::alg::options &) {
+///     std::vector<int> _values{3, 1, 2};
+///     std::sort(_values.begin(), _values.end());
+///     check_that(_values.size() == 3);
+///     check_that(_values.front() == 1);
+///     check_that((_values[1] == 2) && (_values[2] == 3));
+///     return true;
+///   }
+///
+///   static std::string desc() { return "sorts 3 integers"; }
+/// };
+/// \endcode
+#define check_that(expression)                                                 \
+  do {                                                                         \
+    static constexpr tenacitas::lib::test::alg::internal::assertion_site       \
+        tenacitas_site{__FILE__, __LINE__, "check_that", #expression};         \
+    tenacitas_check_begin if (                                                 \
+        !tenacitas::lib::test::alg::internal::assertion_holds(                 \
+            tenacitas::lib::test::alg::internal::decomposer{} <= expression,   \
+            tenacitas_site)) {                                                 \
+      return false;                                                            \
+    }                                                                          \
+    tenacitas_check_end                                                        \
+  } while (false)
+
+/// \brief Checks an expression, like 'check_that', but the test continues if
+/// it is false
+///
+/// \details tenacitas::lib::test::alg::tester makes a test fail if any of its
+/// 'expect_that' fails, even if the test returns 'true', so all the
+/// differences can be reported in one execution. Unlike 'check_that', it can
+/// be used in functions that do not return 'bool', and in other threads
+/// created by the test.
+#define expect_that(expression)                                                \
+  do {                                                                         \
+    static constexpr tenacitas::lib::test::alg::internal::assertion_site       \
+        tenacitas_site{__FILE__, __LINE__, "expect_that", #expression};        \
+    tenacitas_check_begin static_cast<void>(                                   \
+        tenacitas::lib::test::alg::internal::assertion_holds(                  \
+            tenacitas::lib::test::alg::internal::decomposer{} <= expression,   \
+            tenacitas_site));                                                  \
+    tenacitas_check_end                                                        \
+  } while (false)
+
+/// \brief 'decomposer{} <= a == b' is what the compiler would warn about, so
+/// the warning is disabled in the checks
+#define tenacitas_check_begin                                                  \
+  _Pragma("GCC diagnostic push")                                               \
+      _Pragma("GCC diagnostic ignored \"-Wparentheses\"")
+
+#define tenacitas_check_end _Pragma("GCC diagnostic pop")
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Where a check is, and how it was written
+struct assertion_site {
+  const char *file;
+  int line;
+  const char *macro;
+  const char *expression;
+};
+
+/// \brief Number of checks executed by the current thread
+inline thread_local std::uint64_t assertions_checked{0};
+
+/// \brief Number of checks that failed, in any thread
+inline std::atomic<std::uint64_t> assertions_failed{0};
+
+/// \brief Counters of checks when a test started, used to find how many
+/// checks the test executed, and how many failed
+struct assertion_snapshot {
+  assertion_snapshot()
+      : m_checked(assertions_checked),
+        m_failed(assertions_failed.load(std::memory_order_relaxed)) {}
+
+  std::uint64_t checked() const { return assertions_checked - m_checked; }
+
+  std::uint64_t failed() const {
+    return assertions_failed.load(std::memory_order_relaxed) - m_failed;
+  }
+
+private:
+  std::uint64_t m_checked;
+  std::uint64_t m_failed;
+};
+
+template <typename t_value, typename = void>
+struct is_printable : std::false_type {};
+
+template <typename t_value>
+struct is_printable<t_value,
+                    std::void_t<decltype(std::declval<std::ostream &>()
+                                         << std::declval<const t_value &>())>>
+    : std::true_type {};
+
+/// \brief Prints the value of one side of a check, or '{?}' if it can not be
+/// printed
+template <typename t_value>
+void print_checked_value(std::ostream &p_out, const t_value &p_value) {
+  using value = std::decay_t<t_value>;
+  if constexpr (std::is_array_v<t_value>) {
+    if constexpr (std::is_same_v<value, char *> ||
+                  std::is_same_v<value, const char *>) {
+      p_out << '"' << p_value << '"';
+    } else {
+      p_out << "{?}";
+    }
+  } else if constexpr (std::is_same_v<value, bool>) {
+    p_out << (p_value ? "true" : "false");
+  } else if constexpr (std::is_same_v<value, std::nullptr_t>) {
+    p_out << "nullptr";
+  } else if constexpr (std::is_same_v<value, char *> ||
+                       std::is_same_v<value, const char *>) {
+    if (p_value == nullptr) {
+      p_out << "nullptr";
+    } else {
+      p_out << '"' << p_value << '"';
+    }
+  } else if constexpr (std::is_same_v<value, std::string> ||
+                       std::is_same_v<value, std::string_view>) {
+    p_out << '"' << p_value << '"';
+  } else if constexpr (std::is_same_v<value, char>) {
+    p_out << '\'' << p_value << '\'';
+  } else if constexpr (std::is_enum_v<value> && !is_printable<value>::value) {
+    p_out << static_cast<std::underlying_type_t<value>>(p_value);
+  } else if constexpr (is_printable<value>::value) {
+    p_out << p_value;
+  } else {
+    p_out << "{?}";
+  }
+}
+
+/// \brief How an operand of a check is kept: scalars are copied, so they can
+/// stay in registers, and other types are referred
+template <typename t_value>
+using operand =
+    std::conditional_t<std::is_scalar_v<t_value>, t_value, const t_value &>;
+
+/// \brief Comparisons decomposed by 'check_that' and 'expect_that'
+struct op_equal {
+  static constexpr std::string_view symbol{"=="};
+
+  template <typename t_left, typename t_right>
+  static bool apply(const t_left &p_left, const t_right &p_right) {
+    return static_cast<bool>(p_left == p_right);
+  }
+};
+
+struct op_not_equal {
+  static constexpr std::string_view symbol{"!="};
+
+  template <typename t_left, typename t_right>
+  static bool apply(const t_left &p_left, const t_right &p_right) {
+    return static_cast<bool>(p_left != p_right);
+  }
+};
+
+struct op_less {
+  static constexpr std::string_view symbol{"<"};
+
+  template <typename t_left, typename t_right>
+  static bool apply(const t_left &p_left, const t_right &p_right) {
+    return static_cast<bool>(p_left < p_right);
+  }
+};
+
+struct op_less_equal {
+  static constexpr std::string_view symbol{"<="};
+
+  template <typename t_left, typename t_right>
+  static bool apply(const t_left &p_left, const t_right &p_right) {
+    return static_cast<bool>(p_left <= p_right);
+  }
+};
+
+struct op_greater {
+  static constexpr std::string_view symbol{">"};
+
+  template <typename t_left, typename t_right>
+  static bool apply(const t_left &p_left, const t_right &p_right) {
+    return static_cast<bool>(p_left > p_right);
+  }
+};
+
+struct op_greater_equal {
+  static constexpr std::string_view symbol{">="};
+
+  template <typename t_left, typename t_right>
+  static bool apply(const t_left &p_left, const t_right &p_right) {
+    return static_cast<bool>(p_left >= p_right);
+  }
+};
+
+/// \brief A comparison decomposed by 'check_that' or 'expect_that'
+///
+/// \details The operands that are not scalars are referred, and live until
+/// the end of the expression in the macro
+template <typename t_left, typename t_op, typename t_right>
+struct binary_expression {
+  operand<t_left> left;
+  operand<t_right> right;
+
+  bool passed() const { return t_op::apply(left, right); }
+
+  void print(std::ostream &p_out) const {
+    print_checked_value(p_out, left);
+    p_out << ' ' << t_op::symbol << ' ';
+    print_checked_value(p_out, right);
+  }
+};
+
+/// \brief The left side of a comparison, or an expression that is not a
+/// comparison
+template <typename t_value> struct unary_expression {
+  operand<t_value> value;
+
+  bool passed() const { return static_cast<bool>(value); }
+
+  void print(std::ostream &p_out) const { print_checked_value(p_out, value); }
+
+  template <typename t_right>
+  binary_expression<t_value, op_equal, t_right>
+  operator==(const t_right &p_right) && {
+    return {value, p_right};
+  }
+
+  template <typename t_right>
+  binary_expression<t_value, op_not_equal, t_right>
+  operator!=(const t_right &p_right) && {
+    return {value, p_right};
+  }
+
+  template <typename t_right>
+  binary_expression<t_value, op_less, t_right>
+  operator<(const t_right &p_right) && {
+    return {value, p_right};
+  }
+
+  template <typename t_right>
+  binary_expression<t_value, op_less_equal, t_right>
+  operator<=(const t_right &p_right) && {
+    return {value, p_right};
+  }
+
+  template <typename t_right>
+  binary_expression<t_value, op_greater, t_right>
+  operator>(const t_right &p_right) && {
+    return {value, p_right};
+  }
+
+  template <typename t_right>
+  binary_expression<t_value, op_greater_equal, t_right>
+  operator>=(const t_right &p_right) && {
+    return {value, p_right};
+  }
+};
+
+/// \brief Captures the left side of the expression checked, as 'operator<='
+/// has precedence over the comparisons in 'decomposer{} <= a == b'
+struct decomposer {
+  template <typename t_value>
+  unary_expression<t_value> operator<=(const t_value &p_value) && {
+    return {p_value};
+  }
+};
+
+/// \brief Prints a check that failed, and counts it
+///
+/// \details It is not inlined, and is marked as cold, so the code that
+/// formats the values is out of the path of the checks that pass. The
+/// expression is received by value, so the scalars compared are passed in
+/// registers, and nothing is written to the stack before the comparison.
+template <typename t_expression>
+[[gnu::cold, gnu::noinline]] void
+assertion_failed(t_expression p_expression, const assertion_site &p_site) {
+  assertions_failed.fetch_add(1, std::memory_order_relaxed);
+  std::cerr << p_site.file << ':' << p_site.line << ": " << p_site.macro
+            << '(' << p_site.expression << ") failed, with ";
+  p_expression.print(std::cerr);
+  std::cerr << std::endl;
+}
+
+template <typename t_expression>
+inline bool assertion_holds(t_expression p_expression,
+                            const assertion_site &p_site) {
+  ++assertions_checked;
+  if (p_expression.passed()) {
+    return true;
+  }
+  assertion_failed(p_expression, p_site);
+  return false;
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,406 @@
+#ifndef TENACITAS_LIB_TEST_ALG_COMPARE_ARRAYS_H
+#define TENACITAS_LIB_TEST_ALG_COMPARE_ARRAYS_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace tenacitas::lib::test::alg {
+
+/// \brief How two values are compared by \p compare_arrays
+enum class tolerance_kind : std::uint8_t {
+  /// \brief The values must be equal
+  exact,
+  /// \brief The difference must be at most \p tolerance::max
+  absolute,
+  /// \brief The difference must be at most \p tolerance::max times the
+  /// largest of the absolute values
+  relative,
+  /// \brief There must be at most \p tolerance::max_ulp representable values
+  /// from one value to the other
+  ulp
+};
+
+/// \brief Tolerance of \p compare_arrays
+///
+/// \details Whatever the kind, equal values match, and NaN matches only NaN.
+/// Integral values can only be compared with \p exact.
+struct tolerance {
+  static constexpr tolerance exact() {
+    return {tolerance_kind::exact, 0.0, 0};
+  }
+
+  static constexpr tolerance absolute(double p_max) {
+    return {tolerance_kind::absolute, p_max, 0};
+  }
+
+  static constexpr tolerance relative(double p_max) {
+    return {tolerance_kind::relative, p_max, 0};
+  }
+
+  static constexpr tolerance ulp(std::uint64_t p_max_ulp) {
+    return {tolerance_kind::ulp, 0.0, p_max_ulp};
+  }
+
+  tolerance_kind kind;
+  double max;
+  std::uint64_t max_ulp;
+};
+
+/// \brief A position where the arrays compared by \p compare_arrays differ
+template <typename t_value> struct array_mismatch {
+  std::size_t index;
+  t_value expected;
+  t_value actual;
+};
+
+/// \brief Result of \p compare_arrays
+///
+/// \details It converts to \p true if the arrays match, and prints the
+/// number of mismatches, and the first ones, so it can be used in
+/// 'check_that':
+///
+/// \code
+/// check_that(test::alg::compare_arrays(_expected, _actual,
+///                                      test::alg::tolerance::ulp(4)));
+/// \endcode
+template <typename t_value> struct array_comparison {
+  std::size_t expected_size{0};
+  std::size_t actual_size{0};
+
+  /// \brief Number of positions where the values do not match
+  std::size_t mismatches{0};
+
+  /// \brief The first mismatches, in the order of the indexes
+  std::vector<array_mismatch<t_value>> first;
+
+  explicit operator bool() const {
+    return (expected_size == actual_size) && (mismatches == 0);
+  }
+};
+
+template <typename t_value>
+std::ostream &operator<<(std::ostream &p_out,
+                         const array_comparison<t_value> &p_comparison) {
+  if (p_comparison.expected_size != p_comparison.actual_size) {
+    p_out << "expected " << p_comparison.expected_size << " values, but got "
+          << p_comparison.actual_size << "; ";
+  }
+  p_out << p_comparison.mismatches << " mismatch(es)";
+  const std::streamsize _precision{p_out.precision()};
+  if constexpr (std::is_floating_point_v<t_value>) {
+    p_out.precision(std::numeric_limits<t_value>::max_digits10);
+  }
+  for (const array_mismatch<t_value> &_mismatch : p_comparison.first) {
+    p_out << "\n  [" << _mismatch.index << "] expected " << +_mismatch.expected
+          << ", actual " << +_mismatch.actual;
+  }
+  if (p_comparison.first.size() < p_comparison.mismatches) {
+    p_out << "\n  ...";
+  }
+  p_out.precision(_precision);
+  return p_out;
+}
+
+namespace internal {
+
+/// \brief Instruction set used to compare arrays
+enum class simd_level : std::uint8_t { scalar, sse2, avx2 };
+
+/// \brief The widest instruction set supported by the CPU
+inline simd_level detected_simd_level() {
+#if defined(__x86_64__)
+  static const simd_level _level{__builtin_cpu_supports("avx2")
+                                     ? simd_level::avx2
+                                     : simd_level::sse2};
+  return _level;
+#else
+  return simd_level::scalar;
+#endif
+}
+
+/// \brief Matching rules of \p tolerance_kind
+///
+/// \details They are written without branches, using '&' and '|' on 'bool',
+/// so that the compiler vectorizes the loop in \p scan_blocks
+template <typename t_value> struct exact_match {
+  bool operator()(t_value p_expected, t_value p_actual) const {
+    if constexpr (std::is_floating_point_v<t_value>) {
+      return (p_expected == p_actual) |
+             ((p_expected != p_expected) & (p_actual != p_actual));
+    } else {
+      return p_expected == p_actual;
+    }
+  }
+};
+
+template <typename t_value> struct absolute_match {
+  bool operator()(t_value p_expected, t_value p_actual) const {
+    return (std::fabs(p_expected - p_actual) <= max) |
+           exact_match<t_value>{}(p_expected, p_actual);
+  }
+
+  t_value max;
+};
+
+template <typename t_value> struct relative_match {
+  bool operator()(t_value p_expected, t_value p_actual) const {
+    const t_value _diff{std::fabs(p_expected - p_actual)};
+    const t_value _expected{std::fabs(p_expected)};
+    const t_value _actual{std::fabs(p_actual)};
+    const t_value _largest{_expected < _actual ? _actual : _expected};
+    return ((_diff <= max * _largest) &
+            (_diff <= std::numeric_limits<t_value>::max())) |
+           exact_match<t_value>{}(p_expected, p_actual);
+  }
+
+  t_value max;
+};
+
+/// \details The bits of each value are mapped to an unsigned integer that
+/// grows with the value, so the distance between the integers is the number
+/// of representable values between them, and -0 and +0 are the same
+template <typename t_value> struct ulp_match {
+  using bits = std::conditional_t<sizeof(t_value) == 4, std::uint32_t,
+                                  std::uint64_t>;
+
+  static constexpr bits sign{bits{1} << (sizeof(bits) * 8 - 1)};
+
+  static constexpr bits infinity{static_cast<bits>(
+      sizeof(t_value) == 4 ? 0x7F800000ULL : 0x7FF0000000000000ULL)};
+
+  bool operator()(t_value p_expected, t_value p_actual) const {
+    bits _expected;
+    bits _actual;
+    std::memcpy(&_expected, &p_expected, sizeof(bits));
+    std::memcpy(&_actual, &p_actual, sizeof(bits));
+    const bits _expected_magnitude{_expected & ~sign};
+    const bits _actual_magnitude{_actual & ~sign};
+    const bits _expected_ordered{(_expected & sign)
+                                     ? sign - _expected_magnitude
+                                     : sign + _expected_magnitude};
+    const bits _actual_ordered{(_actual & sign) ? sign - _actual_magnitude
+                                                : sign + _actual_magnitude};
+    const bits _distance{_expected_ordered > _actual_ordered
+                             ? _expected_ordered - _actual_ordered
+                             : _actual_ordered - _expected_ordered};
+    const bool _expected_nan{_expected_magnitude > infinity};
+    const bool _actual_nan{_actual_magnitude > infinity};
+    return ((_distance <= max) & !_expected_nan & !_actual_nan) |
+           (_expected_nan & _actual_nan);
+  }
+
+  bits max;
+};
+
+/// \brief Counts the mismatches from \p p_begin to \p p_end, and keeps the
+/// first \p p_max_reported
+template <typename t_value, typename t_match>
+void record_mismatches(const t_value *p_expected, const t_value *p_actual,
+                       std::size_t p_begin, std::size_t p_end,
+                       const t_match &p_match, std::size_t p_max_reported,
+                       array_comparison<t_value> &p_comparison) {
+  for (std::size_t _i = p_begin; _i < p_end; ++_i) {
+    if (!p_match(p_expected[_i], p_actual[_i])) {
+      ++p_comparison.mismatches;
+      if (p_comparison.first.size() < p_max_reported) {
+        p_comparison.first.push_back({_i, p_expected[_i], p_actual[_i]});
+      }
+    }
+  }
+}
+
+/// \brief Number of values checked, without branches, before deciding if
+/// they must be checked one by one
+inline constexpr std::size_t compare_block{64};
+
+/// \brief Checks blocks of \p compare_block values with a loop that the
+/// compiler vectorizes, and checks one by one only the blocks that have a
+/// mismatch, so the usual case, where all match, runs at the speed of the
+/// memory
+template <typename t_value, typename t_match>
+[[gnu::always_inline]] inline void
+scan_blocks(const t_value *p_expected, const t_value *p_actual,
+            std::size_t p_size, const t_match &p_match,
+            std::size_t p_max_reported,
+            array_comparison<t_value> &p_comparison) {
+  std::size_t _begin{0};
+  for (; _begin + compare_block <= p_size; _begin += compare_block) {
+    unsigned _match{1};
+    for (std::size_t _i = 0; _i < compare_block; ++_i) {
+      _match &= static_cast<unsigned>(
+          p_match(p_expected[_begin + _i], p_actual[_begin + _i]));
+    }
+    if (!_match) {
+      record_mismatches(p_expected, p_actual, _begin, _begin + compare_block,
+                        p_match, p_max_reported, p_comparison);
+    }
+  }
+  record_mismatches(p_expected, p_actual, _begin, p_size, p_match,
+                    p_max_reported, p_comparison);
+}
+
+template <typename t_value, typename t_match>
+void scan_blocks_sse2(const t_value *p_expected, const t_value *p_actual,
+                      std::size_t p_size, const t_match &p_match,
+                      std::size_t p_max_reported,
+                      array_comparison<t_value> &p_comparison) {
+  scan_blocks(p_expected, p_actual, p_size, p_match, p_max_reported,
+              p_comparison);
+}
+
+#if defined(__x86_64__)
+template <typename t_value, typename t_match>
+[[gnu::target("avx2")]] void
+scan_blocks_avx2(const t_value *p_expected, const t_value *p_actual,
+                 std::size_t p_size, const t_match &p_match,
+                 std::size_t p_max_reported,
+                 array_comparison<t_value> &p_comparison) {
+  scan_blocks(p_expected, p_actual, p_size, p_match, p_max_reported,
+              p_comparison);
+}
+#endif
+
+template <typename t_value, typename t_match>
+void scan(simd_level p_level, const t_value *p_expected,
+          const t_value *p_actual, std::size_t p_size, const t_match &p_match,
+          std::size_t p_max_reported,
+          array_comparison<t_value> &p_comparison) {
+  switch (p_level) {
+#if defined(__x86_64__)
+  case simd_level::avx2:
+    scan_blocks_avx2(p_expected, p_actual, p_size, p_match, p_max_reported,
+                     p_comparison);
+    break;
+#endif
+  case simd_level::sse2:
+    scan_blocks_sse2(p_expected, p_actual, p_size, p_match, p_max_reported,
+                     p_comparison);
+    break;
+  default:
+    record_mismatches(p_expected, p_actual, 0, p_size, p_match,
+                      p_max_reported, p_comparison);
+  }
+}
+
+/// \brief \p compare_arrays with the instruction set defined by \p p_level
+///
+/// \throw std::invalid_argument if \p t_value is integral, and \p
+/// p_tolerance is not \p tolerance_kind::exact
+template <typename t_value>
+array_comparison<t_value>
+compare_arrays(simd_level p_level, const t_value *p_expected,
+               std::size_t p_expected_size, const t_value *p_actual,
+               std::size_t p_actual_size, tolerance p_tolerance,
+               std::size_t p_max_reported) {
+  static_assert(std::is_arithmetic_v<t_value>,
+                "only arrays of integral and floating point values can be "
+                "compared");
+
+  array_comparison<t_value> _comparison;
+  _comparison.expected_size = p_expected_size;
+  _comparison.actual_size = p_actual_size;
+  const std::size_t _size{std::min(p_expected_size, p_actual_size)};
+
+  if constexpr (std::is_floating_point_v<t_value>) {
+    static_assert(sizeof(t_value) == 4 || sizeof(t_value) == 8,
+                  "only 'float' and 'double' can be compared with tolerance");
+    switch (p_tolerance.kind) {
+    case tolerance_kind::exact:
+      scan(p_level, p_expected, p_actual, _size, exact_match<t_value>{},
+           p_max_reported, _comparison);
+      break;
+    case tolerance_kind::absolute:
+      scan(p_level, p_expected, p_actual, _size,
+           absolute_match<t_value>{static_cast<t_value>(p_tolerance.max)},
+           p_max_reported, _comparison);
+      break;
+    case tolerance_kind::relative:
+      scan(p_level, p_expected, p_actual, _size,
+           relative_match<t_value>{static_cast<t_value>(p_tolerance.max)},
+           p_max_reported, _comparison);
+      break;
+    case tolerance_kind::ulp: {
+      using bits = typename ulp_match<t_value>::bits;
+      scan(p_level, p_expected, p_actual, _size,
+           ulp_match<t_value>{static_cast<bits>(
+               std::min<std::uint64_t>(p_tolerance.max_ulp,
+                                       std::numeric_limits<bits>::max()))},
+           p_max_reported, _comparison);
+    } break;
+    }
+  } else {
+    if (p_tolerance.kind != tolerance_kind::exact) {
+      throw std::invalid_argument(
+          "integral values can only be compared with 'tolerance::exact'");
+    }
+    scan(p_level, p_expected, p_actual, _size, exact_match<t_value>{},
+         p_max_reported, _comparison);
+  }
+  return _comparison;
+}
+
+} // namespace internal
+
+/// \brief Compares two arrays of numbers, reporting how many values do not
+/// match, and the first \p p_max_reported of them, with their indexes
+///
+/// \details The values are checked in blocks by loops vectorized for SSE2
+/// and for AVX2, chosen when the program runs, according to the CPU, and
+/// only the blocks with a mismatch are checked one by one. On other
+/// architectures the values are checked one by one. The 'double' values
+/// compared with \p tolerance::ulp need the 64 bits comparisons of AVX2 to
+/// be vectorized.
+///
+/// \throw std::invalid_argument if \p t_value is integral, and \p
+/// p_tolerance is not \p tolerance::exact
+///
+/// \code
+/// struct test_fft {
+///   bool operator()(const program::alg::options &) {
+///     const std::vector<float> _expected{load("fft_expected.bin")};
+///     const std::vector<float> _actual{fft(load("fft_input.bin"))};
+///     check_that(test::alg::compare_arrays(_expected, _actual,
+///                                          test::alg::tolerance::ulp(8)));
+///     return true;
+///   }
+///
+///   static std::string desc() { return "compares the FFT to a reference"; }
+/// };
+/// \endcode
+template <typename t_value>
+array_comparison<t_value>
+compare_arrays(const t_value *p_expected, std::size_t p_expected_size,
+               const t_value *p_actual, std::size_t p_actual_size,
+               tolerance p_tolerance = tolerance::exact(),
+               std::size_t p_max_reported = 10) {
+  return internal::compare_arrays(internal::detected_simd_level(), p_expected,
+                                  p_expected_size, p_actual, p_actual_size,
+                                  p_tolerance, p_max_reported);
+}
+
+/// \brief Compares two containers with contiguous values, like
+/// 'std::vector' and 'std::array'
+template <typename t_container>
+auto compare_arrays(const t_container &p_expected, const t_container &p_actual,
+                    tolerance p_tolerance = tolerance::exact(),
+                    std::size_t p_max_reported = 10) {
+  return compare_arrays(p_expected.data(), p_expected.size(), p_actual.data(),
+                        p_actual.size(), p_tolerance, p_max_reported);
+}
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
@@ -0,0 +1,455 @@
+#ifndef TENACITAS_LIB_TEST_ALG_DATASET_CACHE_H
+#define TENACITAS_LIB_TEST_ALG_DATASET_CACHE_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <tenacitas.lib.test/alg/internal/dataset_directory.h>
+#include <tenacitas.lib.test/alg/random.h>
+
+namespace tenacitas::lib::test::alg {
+
+namespace internal {
+
+/// \brief First bytes of a file of a cached dataset
+///
+/// \details The key is written after the header, and the values start at
+/// \p data_offset, which is a multiple of the page size
+struct dataset_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t value_size;
+  std::uint64_t count;
+  std::uint64_t key_size;
+  std::uint64_t data_offset;
+};
+
+inline constexpr char dataset_magic[8]{'T', 'N', 'C', 'T', 'S', 'D', 'A', 'T'};
+
+inline constexpr std::uint32_t dataset_version{1};
+
+/// \brief Identifies a dataset, and is stored in its file, so that datasets
+/// whose keys have the same hash are not confused
+inline std::string dataset_key(std::string_view p_generator_id,
+                               std::string_view p_parameters,
+                               std::uint64_t p_seed, std::size_t p_count,
+                               std::size_t p_value_size) {
+  std::ostringstream _stream;
+  _stream << p_generator_id << '\n'
+          << p_parameters << '\n'
+          << "seed=" << p_seed << ", count=" << p_count
+          << ", value_size=" << p_value_size;
+  return _stream.str();
+}
+
+/// \brief Name of the file of a dataset: the generator id, with characters
+/// other than letters, digits, '-' and '_' replaced by '_', and the FNV-1a
+/// hash of \p p_key
+inline std::string dataset_file_name(std::string_view p_generator_id,
+                                     std::string_view p_key) {
+  std::string _name;
+  for (char _c : p_generator_id.substr(0, 64)) {
+    const bool _valid{((_c >= 'a') && (_c <= 'z')) ||
+                      ((_c >= 'A') && (_c <= 'Z')) ||
+                      ((_c >= '0') && (_c <= '9')) || (_c == '-') ||
+                      (_c == '_')};
+    _name += _valid ? _c : '_';
+  }
+  std::uint64_t _hash{0xCBF29CE484222325};
+  for (char _c : p_key) {
+    _hash ^= static_cast<unsigned char>(_c);
+    _hash *= 0x100000001B3;
+  }
+  std::ostringstream _stream;
+  _stream << _name << '-' << std::hex << std::setw(16) << std::setfill('0')
+          << _hash << ".dataset";
+  return _stream.str();
+}
+
+/// \brief Creates \p p_directory, and its parents, if they do not exist
+///
+/// \throw std::runtime_error if a directory can not be created
+inline void make_dataset_directory(const std::string &p_directory) {
+  for (std::size_t _end = p_directory.find('/', 1);;
+       _end = p_directory.find('/', _end + 1)) {
+    const std::string _path{p_directory.substr(0, _end)};
+    if ((::mkdir(_path.c_str(), 0755) != 0) && (errno != EEXIST)) {
+      throw std::runtime_error("could not create '" + _path +
+                               "': " + std::strerror(errno));
+    }
+    if (_end == std::string::npos) {
+      break;
+    }
+  }
+}
+
+/// \brief Holds an exclusive 'flock' on a file while it exists
+struct dataset_lock {
+  explicit dataset_lock(const std::string &p_path)
+      : m_fd(::open(p_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)) {
+    if (m_fd < 0) {
+      throw std::runtime_error("could not create '" + p_path +
+                               "': " + std::strerror(errno));
+    }
+    while ((::flock(m_fd, LOCK_EX) != 0) && (errno == EINTR)) {
+    }
+  }
+
+  dataset_lock(const dataset_lock &) = delete;
+  dataset_lock &operator=(const dataset_lock &) = delete;
+
+  ~dataset_lock() { ::close(m_fd); }
+
+private:
+  int m_fd;
+};
+
+/// \brief Offset of the values in a file of a dataset with key \p p_key
+inline std::size_t dataset_data_offset(std::string_view p_key) {
+  const std::size_t _page{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))};
+  return ((sizeof(dataset_header) + p_key.size() + _page - 1) / _page) * _page;
+}
+
+/// \brief Maps the file \p p_path read only, if it has the dataset identified
+/// by \p p_key
+///
+/// \details 'MAP_SHARED' makes all the processes that map the file use the
+/// same pages of the page cache, and 'MAP_POPULATE' reads them before the
+/// function returns, so no page fault happens while the dataset is used
+///
+/// \return the address of the mapping, with \p p_size bytes, or 'nullptr' if
+/// the file does not exist, or has another dataset
+inline const void *map_dataset(const std::string &p_path,
+                               std::string_view p_key,
+                               std::size_t p_value_size, std::size_t p_count,
+                               std::size_t &p_size) {
+  const int _fd{::open(p_path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (_fd < 0) {
+    return nullptr;
+  }
+  const std::size_t _offset{dataset_data_offset(p_key)};
+  p_size = _offset + p_value_size * p_count;
+  struct stat _stat {};
+  void *_addr{MAP_FAILED};
+  if ((::fstat(_fd, &_stat) == 0) &&
+      (static_cast<std::size_t>(_stat.st_size) == p_size)) {
+    _addr = ::mmap(nullptr, p_size, PROT_READ, MAP_SHARED | MAP_POPULATE, _fd,
+                   0);
+  }
+  ::close(_fd);
+  if (_addr == MAP_FAILED) {
+    return nullptr;
+  }
+
+  const auto *_header{static_cast<const dataset_header *>(_addr)};
+  const char *_key{static_cast<const char *>(_addr) + sizeof(dataset_header)};
+  if ((std::memcmp(_header->magic, dataset_magic, sizeof(dataset_magic)) !=
+       0) ||
+      (_header->version != dataset_version) ||
+      (_header->value_size != p_value_size) || (_header->count != p_count) ||
+      (_header->key_size != p_key.size()) ||
+      (_header->data_offset != _offset) ||
+      (std::string_view{_key, p_key.size()} != p_key)) {
+    ::munmap(_addr, p_size);
+    return nullptr;
+  }
+  return _addr;
+}
+
+/// \brief Creates the file \p p_path with the dataset identified by \p p_key,
+/// whose values are written by \p p_generate directly in the file mapped in
+/// memory
+///
+/// \details The values are written in a temporary file, which is renamed to
+/// \p p_path, so a process that maps \p p_path never sees a dataset partially
+/// generated. The magic number is written after the values, so the
+/// temporary file of a process that crashed is not valid.
+///
+/// \throw std::runtime_error if the file can not be created, sized, mapped or
+/// renamed
+template <typename t_value, typename t_generator>
+void write_dataset(const std::string &p_path, std::string_view p_key,
+                   std::size_t p_count, std::uint64_t p_seed,
+                   t_generator &p_generate) {
+  const std::string _temporary{p_path + ".tmp." + std::to_string(::getpid())};
+  const int _fd{::open(_temporary.c_str(),
+                       O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+  if (_fd < 0) {
+    throw std::runtime_error("could not create '" + _temporary +
+                             "': " + std::strerror(errno));
+  }
+  const std::size_t _offset{dataset_data_offset(p_key)};
+  const std::size_t _size{_offset + sizeof(t_value) * p_count};
+  if (::ftruncate(_fd, static_cast<off_t>(_size)) != 0) {
+    ::close(_fd);
+    ::unlink(_temporary.c_str());
+    throw std::runtime_error("could not size '" + _temporary +
+                             "': " + std::strerror(errno));
+  }
+  void *_addr{
+      ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0)};
+  ::close(_fd);
+  if (_addr == MAP_FAILED) {
+    ::unlink(_temporary.c_str());
+    throw std::runtime_error("could not map '" + _temporary +
+                             "': " + std::strerror(errno));
+  }
+
+  auto *_header{static_cast<dataset_header *>(_addr)};
+  _header->version = dataset_version;
+  _header->value_size = sizeof(t_value);
+  _header->count = p_count;
+  _header->key_size = p_key.size();
+  _header->data_offset = _offset;
+  std::memcpy(static_cast<char *>(_addr) + sizeof(dataset_header),
+              p_key.data(), p_key.size());
+  try {
+    p_generate(reinterpret_cast<t_value *>(static_cast<char *>(_addr) +
+                                           _offset),
+               p_count, p_seed);
+  } catch (...) {
+    ::munmap(_addr, _size);
+    ::unlink(_temporary.c_str());
+    throw;
+  }
+  std::memcpy(_header->magic, dataset_magic, sizeof(dataset_magic));
+  ::munmap(_addr, _size);
+
+  if (std::rename(_temporary.c_str(), p_path.c_str()) != 0) {
+    const int _error{errno};
+    ::unlink(_temporary.c_str());
+    throw std::runtime_error("could not rename '" + _temporary + "' to '" +
+                             p_path + "': " + std::strerror(_error));
+  }
+}
+
+} // namespace internal
+
+/// \brief Values of a synthetic dataset, mapped read only from a file in the
+/// directory of cached datasets
+///
+/// \details Created by \p cached_dataset. All the processes, and threads, that
+/// use the same dataset share the same physical pages, from the page cache.
+template <typename t_value> struct dataset {
+  using value_type = t_value;
+  using const_iterator = const t_value *;
+
+  dataset() = delete;
+  dataset(const dataset &) = delete;
+  dataset &operator=(const dataset &) = delete;
+
+  dataset(dataset &&p_dataset) noexcept
+      : m_map(p_dataset.m_map), m_map_size(p_dataset.m_map_size),
+        m_data(p_dataset.m_data), m_count(p_dataset.m_count),
+        m_generated(p_dataset.m_generated),
+        m_path(std::move(p_dataset.m_path)) {
+    p_dataset.m_map = nullptr;
+    p_dataset.m_data = nullptr;
+    p_dataset.m_count = 0;
+  }
+
+  dataset &operator=(dataset &&p_dataset) noexcept {
+    if (this != &p_dataset) {
+      unmap();
+      m_map = p_dataset.m_map;
+      m_map_size = p_dataset.m_map_size;
+      m_data = p_dataset.m_data;
+      m_count = p_dataset.m_count;
+      m_generated = p_dataset.m_generated;
+      m_path = std::move(p_dataset.m_path);
+      p_dataset.m_map = nullptr;
+      p_dataset.m_data = nullptr;
+      p_dataset.m_count = 0;
+    }
+    return *this;
+  }
+
+  ~dataset() { unmap(); }
+
+  const t_value *data() const { return m_data; }
+
+  std::size_t size() const { return m_count; }
+
+  const_iterator begin() const { return m_data; }
+
+  const_iterator end() const { return m_data + m_count; }
+
+  const t_value &operator[](std::size_t p_index) const {
+    return m_data[p_index];
+  }
+
+  /// \brief Informs if the values were generated when the dataset was
+  /// created, instead of found in the cache
+  bool generated() const { return m_generated; }
+
+  /// \brief File where the values are
+  const std::string &path() const { return m_path; }
+
+private:
+  template <typename t_type, typename t_generator>
+  friend dataset<t_type> cached_dataset(std::string_view, std::string_view,
+                                        std::uint64_t, std::size_t,
+                                        t_generator &&);
+
+  dataset(const void *p_map, std::size_t p_map_size, std::size_t p_offset,
+          std::size_t p_count, bool p_generated, std::string &&p_path)
+      : m_map(p_map), m_map_size(p_map_size),
+        m_data(reinterpret_cast<const t_value *>(
+            static_cast<const char *>(p_map) + p_offset)),
+        m_count(p_count), m_generated(p_generated), m_path(std::move(p_path)) {
+  }
+
+  void unmap() {
+    if (m_map != nullptr) {
+      ::munmap(const_cast<void *>(m_map), m_map_size);
+      m_map = nullptr;
+    }
+  }
+
+private:
+  const void *m_map{nullptr};
+  std::size_t m_map_size{0};
+  const t_value *m_data{nullptr};
+  std::size_t m_count{0};
+  bool m_generated{false};
+  std::string m_path;
+};
+
+/// \brief Returns the dataset identified by \p p_generator_id, \p p_parameters,
+/// \p p_seed and \p p_count, generating it only if it is not in the directory
+/// of cached datasets
+///
+/// \details The directory is the one passed to
+/// tenacitas::lib::test::alg::tester with '--dataset-cache <dir>', or
+/// '$TMPDIR/tenacitas.lib.test.datasets'. The first run that needs a dataset
+/// calls \p p_generate to write the values directly in a new file, mapped in
+/// memory, and the next runs, and the other tests, threads and processes
+/// running in parallel, map the file read only, instead of generating it
+/// again. An exclusive 'flock' makes a dataset be generated once, even if
+/// many processes need it at the same time.
+///
+/// To have a dataset generated again after \p p_generate changes, its
+/// \p p_generator_id, or \p p_parameters, must change, or its file must be
+/// removed from the directory.
+///
+/// \tparam t_value must be trivially copyable, as it is read from the file
+/// without being constructed
+///
+/// \tparam t_generator must implement
+/// \code
+/// void operator()(t_value *p_data, std::size_t p_count, std::uint64_t p_seed)
+/// \endcode
+/// writing \p p_count values in \p p_data, which are a function only of the
+/// parameters and of \p p_seed
+///
+/// \param p_parameters describes the parameters of the generator, like
+/// "items=1000000, exponent=0.99"
+///
+/// \throw std::runtime_error if the directory or the file can not be created,
+/// or mapped
+///
+/// \code
+/// struct bench_hash_lookup {
+///   bench_hash_lookup()
+///       : m_keys(test::alg::cached_dataset<std::uint64_t>(
+///             "zipf-keys", "items=10000000, exponent=0.99", 500000000,
+///             [](std::uint64_t *p_keys, std::size_t p_count,
+///                std::uint64_t p_seed) {
+///               test::alg::xoshiro256pp _engine{p_seed};
+///               test::alg::fill_zipf(_engine, p_keys, p_count, 10000000,
+///                                    0.99, true);
+///             })) {}
+///
+///   void operator()(const program::alg::options &) {
+///     for (std::size_t _i = 0; _i < 1000; ++_i) {
+///       m_sum += m_table.count(m_keys[m_next++ % m_keys.size()]);
+///     }
+///   }
+///
+///   static std::string desc() {
+///     return "looks up 4G of zipf keys, generated once";
+///   }
+///
+///   test::alg::dataset<std::uint64_t> m_keys;
+///   my_hash_table m_table;
+///   std::size_t m_next{0};
+///   std::size_t m_sum{0};
+/// };
+/// \endcode
+template <typename t_value, typename t_generator>
+dataset<t_value> cached_dataset(std::string_view p_generator_id,
+                                std::string_view p_parameters,
+                                std::uint64_t p_seed, std::size_t p_count,
+                                t_generator &&p_generate) {
+  static_assert(std::is_trivially_copyable_v<t_value>,
+                "values of a cached dataset must be trivially copyable");
+
+  const std::string _key{internal::dataset_key(
+      p_generator_id, p_parameters, p_seed, p_count, sizeof(t_value))};
+  const std::string _directory{internal::current_dataset_directory()};
+  std::string _path{_directory + '/' +
+                    internal::dataset_file_name(p_generator_id, _key)};
+  const std::size_t _offset{internal::dataset_data_offset(_key)};
+  std::size_t _size{0};
+
+  const void *_map{
+      internal::map_dataset(_path, _key, sizeof(t_value), p_count, _size)};
+  if (_map != nullptr) {
+    return {_map, _size, _offset, p_count, false, std::move(_path)};
+  }
+
+  internal::make_dataset_directory(_directory);
+  const internal::dataset_lock _lock{_path + ".lock"};
+  // another process may have generated it while this one waited for the lock
+  _map = internal::map_dataset(_path, _key, sizeof(t_value), p_count, _size);
+  if (_map != nullptr) {
+    return {_map, _size, _offset, p_count, false, std::move(_path)};
+  }
+
+  internal::write_dataset<t_value>(_path, _key, p_count, p_seed, p_generate);
+  _map = internal::map_dataset(_path, _key, sizeof(t_value), p_count, _size);
+  if (_map == nullptr) {
+    throw std::runtime_error("could not map '" + _path + "'");
+  }
+  return {_map, _size, _offset, p_count, true, std::move(_path)};
+}
+
+/// \brief Returns a cached dataset whose seed is derived from
+/// \p p_generator_id and from '--seed', so all the tests that use the same
+/// generator, with the same parameters, share the dataset
+///
+/// \details See the other overload of \p cached_dataset
+template <typename t_value, typename t_generator>
+dataset<t_value> cached_dataset(std::string_view p_generator_id,
+                                std::string_view p_parameters,
+                                std::size_t p_count, t_generator &&p_generate) {
+  return cached_dataset<t_value>(p_generator_id, p_parameters,
+                                 internal::seed_of(p_generator_id), p_count,
+                                 std::forward<t_generator>(p_generate));
+}
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
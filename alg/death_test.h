@@ -0,0 +1,263 @@
+#ifndef TENACITAS_LIB_TEST_ALG_DEATH_TEST_H
+#define TENACITAS_LIB_TEST_ALG_DEATH_TEST_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace tenacitas::lib::test::alg {
+
+/// \brief How long \p expect_death waits for the callable to die, before
+/// killing it and failing
+inline constexpr std::chrono::milliseconds death_timeout{10000};
+
+namespace internal {
+
+/// \brief How a process created by \p run_to_death ended
+struct death {
+  /// \brief If the process was terminated by a signal
+  bool signaled{false};
+
+  /// \brief Signal that terminated the process, or its exit code
+  int code{0};
+
+  /// \brief If the process was killed because it did not end in time
+  bool timed_out{false};
+
+  /// \brief What the process wrote to 'stderr'
+  std::string output;
+};
+
+inline std::ostream &operator<<(std::ostream &p_out, const death &p_death) {
+  if (p_death.timed_out) {
+    p_out << "did not end in time";
+  } else if (p_death.signaled) {
+    p_out << "was terminated by signal " << p_death.code << " ("
+          << ::strsignal(p_death.code) << ')';
+  } else {
+    p_out << "exited with " << p_death.code;
+  }
+  return p_out << ", writing '" << p_death.output << "' to stderr";
+}
+
+/// \brief Executes \p p_callable in a child process created with 'fork', and
+/// collects how it ended, and what it wrote to 'stderr'
+///
+/// \details The child does not call 'exec', so creating it costs only copying
+/// the page tables of the test program. In the child, 'stderr' is redirected
+/// to a pipe, core dumps are disabled, and the crash signals get back their
+/// default action, so that the handlers installed by '--result-log' do not
+/// write in the log shared with the parent. If \p p_callable returns, the
+/// child exits with 0; if it throws, 'std::terminate' is called, as it would
+/// be for an uncaught exception.
+///
+/// \throw std::runtime_error if the pipe or the process can not be created
+template <typename t_callable>
+death run_to_death(t_callable &p_callable,
+                   std::chrono::milliseconds p_timeout) {
+  int _pipe[2];
+  if (::pipe(_pipe) != 0) {
+    throw std::runtime_error(std::string{"could not create pipe: "} +
+                             std::strerror(errno));
+  }
+
+  const pid_t _pid{::fork()};
+  if (_pid < 0) {
+    ::close(_pipe[0]);
+    ::close(_pipe[1]);
+    throw std::runtime_error(std::string{"could not fork: "} +
+                             std::strerror(errno));
+  }
+
+  if (_pid == 0) {
+    ::close(_pipe[0]);
+    ::dup2(_pipe[1], STDERR_FILENO);
+    ::close(_pipe[1]);
+    for (int _signal : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+      ::signal(_signal, SIG_DFL);
+    }
+    const rlimit _no_core{0, 0};
+    ::setrlimit(RLIMIT_CORE, &_no_core);
+    try {
+      p_callable();
+    } catch (...) {
+      std::terminate();
+    }
+    ::_exit(0);
+  }
+
+  ::close(_pipe[1]);
+
+  death _death;
+  const auto _deadline{std::chrono::steady_clock::now() + p_timeout};
+  char _buffer[4096];
+  while (true) {
+    const auto _left{std::chrono::duration_cast<std::chrono::milliseconds>(
+        _deadline - std::chrono::steady_clock::now())};
+    if (_left.count() <= 0) {
+      _death.timed_out = true;
+      break;
+    }
+    pollfd _poll{_pipe[0], POLLIN, 0};
+    const int _ready{::poll(&_poll, 1, static_cast<int>(_left.count()))};
+    if (_ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      _death.timed_out = true;
+      break;
+    }
+    if (_ready == 0) {
+      continue;
+    }
+    const ssize_t _read{::read(_pipe[0], _buffer, sizeof(_buffer))};
+    if (_read > 0) {
+      _death.output.append(_buffer, static_cast<std::size_t>(_read));
+    } else if ((_read == 0) || (errno != EINTR)) {
+      break;
+    }
+  }
+  ::close(_pipe[0]);
+
+  // the child may close 'stderr' and keep running, so the deadline is still
+  // checked while waiting for it to end
+  int _status{0};
+  while (!_death.timed_out) {
+    const pid_t _ended{::waitpid(_pid, &_status, WNOHANG)};
+    if (_ended == _pid) {
+      break;
+    }
+    if ((_ended < 0) && (errno != EINTR)) {
+      break;
+    }
+    if (std::chrono::steady_clock::now() >= _deadline) {
+      _death.timed_out = true;
+      break;
+    }
+    ::usleep(1000);
+  }
+
+  if (_death.timed_out) {
+    ::kill(_pid, SIGKILL);
+    while ((::waitpid(_pid, &_status, 0) < 0) && (errno == EINTR)) {
+    }
+  }
+  if (WIFSIGNALED(_status)) {
+    _death.signaled = true;
+    _death.code = WTERMSIG(_status);
+  } else if (WIFEXITED(_status)) {
+    _death.code = WEXITSTATUS(_status);
+  }
+  return _death;
+}
+
+/// \brief Informs if \p p_output matches \p p_pattern, which is an
+/// ECMAScript regular expression searched in \p p_output
+inline bool death_output_matches(const std::string &p_output,
+                                 std::string_view p_pattern) {
+  if (p_pattern.empty()) {
+    return true;
+  }
+  return std::regex_search(p_output,
+                           std::regex{p_pattern.begin(), p_pattern.end()});
+}
+
+} // namespace internal
+
+/// \brief Checks that \p p_callable terminates the process with the signal
+/// \p p_signal, writing to 'stderr' something that matches \p p_pattern
+///
+/// \details \p p_callable is executed in a child process, created with 'fork'
+/// and not followed by 'exec', so the check costs much less than a
+/// millisecond, and the test program is not affected by the death. If the
+/// check fails, the reason is written to 'std::cerr'.
+///
+/// As in any program that forks, if other threads of the test hold locks,
+/// like the one of 'malloc', when \p expect_death is called, the child may
+/// block until \p p_timeout expires.
+///
+/// \param p_pattern is an ECMAScript regular expression searched in what the
+/// child wrote to 'stderr'; if it is empty, any output is accepted
+///
+/// \param p_timeout is how long the child can run before it is killed, and
+/// the check fails
+///
+/// \throw std::runtime_error if the child process can not be created
+///
+/// \code
+/// struct test_pop_empty {
+///   bool operator()(const program::alg::options &) {
+///     return test::alg::expect_death(
+///         []() {
+///           my_stack _stack;
+///           _stack.pop();
+///         },
+///         SIGABRT, "pop on empty stack");
+///   }
+///
+///   static std::string desc() { return "'pop' aborts if the stack is empty"; }
+/// };
+/// \endcode
+template <typename t_callable>
+bool expect_death(t_callable &&p_callable, int p_signal,
+                  std::string_view p_pattern = {},
+                  std::chrono::milliseconds p_timeout = death_timeout) {
+  const internal::death _death{internal::run_to_death(p_callable, p_timeout)};
+  if (_death.timed_out || !_death.signaled || (_death.code != p_signal)) {
+    std::cerr << "expected the process to be terminated by signal " << p_signal
+              << " (" << ::strsignal(p_signal) << "), but it " << _death
+              << std::endl;
+    return false;
+  }
+  if (!internal::death_output_matches(_death.output, p_pattern)) {
+    std::cerr << "expected stderr to match '" << p_pattern << "', but it "
+              << _death << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/// \brief Checks that \p p_callable terminates the process, by any signal or
+/// by exiting with a code different from 0, writing to 'stderr' something
+/// that matches \p p_pattern
+///
+/// \details See the other overload of \p expect_death
+template <typename t_callable>
+bool expect_death(t_callable &&p_callable, std::string_view p_pattern,
+                  std::chrono::milliseconds p_timeout = death_timeout) {
+  const internal::death _death{internal::run_to_death(p_callable, p_timeout)};
+  if (_death.timed_out || (!_death.signaled && (_death.code == 0))) {
+    std::cerr << "expected the process to die, but it " << _death
+              << std::endl;
+    return false;
+  }
+  if (!internal::death_output_matches(_death.output, p_pattern)) {
+    std::cerr << "expected stderr to match '" << p_pattern << "', but it "
+              << _death << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
@@ -0,0 +1,486 @@
+#ifndef TENACITAS_LIB_TEST_ALG_DIFF_SEQUENCES_H
+#define TENACITAS_LIB_TEST_ALG_DIFF_SEQUENCES_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tenacitas.lib.test/alg/check.h>
+
+namespace tenacitas::lib::test::alg {
+
+/// \brief Kind of a run of an edit script
+enum class edit_kind : std::uint8_t { equal, remove, insert };
+
+/// \brief Values that are equal, removed from the expected sequence, or
+/// inserted in the actual sequence
+struct edit_run {
+  edit_kind kind;
+  std::size_t expected_index;
+  std::size_t actual_index;
+  std::size_t length;
+};
+
+/// \brief Result of \p diff_sequences
+///
+/// \details It converts to \p true if the sequences are equal, and prints
+/// the number of values removed and inserted, followed by the runs that
+/// differ, with \p context equal values around them, in the format of
+/// 'diff -u', at most \p max_lines lines, so it can be used in 'check_that':
+///
+/// \code
+/// check_that(test::alg::diff_sequences(_expected, _actual));
+/// \endcode
+///
+/// It refers to the sequences compared, which must live while it is used.
+template <typename t_sequence> struct sequence_diff {
+  const t_sequence &expected;
+  const t_sequence &actual;
+
+  /// \brief The edit script, that transforms \p expected into \p actual
+  std::vector<edit_run> runs{};
+
+  std::size_t removed{0};
+  std::size_t inserted{0};
+
+  /// \brief If the edit script is the shortest one, which may not be the
+  /// case if the work limit of \p diff_sequences was reached
+  bool minimal{true};
+
+  std::size_t context{3};
+  std::size_t max_lines{200};
+
+  explicit operator bool() const { return (removed == 0) && (inserted == 0); }
+};
+
+namespace internal {
+
+/// \brief Linear space variant of the diff algorithm of Eugene W. Myers,
+/// "An O(ND) Difference Algorithm and Its Variations", 1986, as in GNU diff
+///
+/// \details The middle snake of the shortest edit script splits the
+/// sequences in two, which are compared recursively, so the memory used is
+/// proportional to the size of the sequences. If more than \p m_max_cost
+/// differences are searched before the middle snake is found, the sequences
+/// are split at the furthest point reached, and the script may not be the
+/// shortest.
+template <typename t_iterator> struct myers_diff {
+  myers_diff(t_iterator p_expected, std::ptrdiff_t p_expected_size,
+             t_iterator p_actual, std::ptrdiff_t p_actual_size,
+             std::ptrdiff_t p_max_cost)
+      : m_expected(p_expected), m_actual(p_actual),
+        m_removed(static_cast<std::size_t>(p_expected_size), 0),
+        m_inserted(static_cast<std::size_t>(p_actual_size), 0),
+        m_forward(static_cast<std::size_t>(p_expected_size + p_actual_size + 3)),
+        m_backward(m_forward.size()), m_offset(p_actual_size + 1),
+        m_max_cost(std::max<std::ptrdiff_t>(p_max_cost, 1)) {
+    compare(0, p_expected_size, 0, p_actual_size);
+  }
+
+  /// \brief Builds the runs of the edit script
+  template <typename t_sequence>
+  void script(sequence_diff<t_sequence> &p_diff) const {
+    const std::size_t _expected_size{m_removed.size()};
+    const std::size_t _actual_size{m_inserted.size()};
+    std::size_t _x{0};
+    std::size_t _y{0};
+    while ((_x < _expected_size) || (_y < _actual_size)) {
+      edit_run _run{edit_kind::equal, _x, _y, 0};
+      if ((_x < _expected_size) && m_removed[_x]) {
+        _run.kind = edit_kind::remove;
+        while ((_x < _expected_size) && m_removed[_x]) {
+          ++_x;
+          ++_run.length;
+        }
+        p_diff.removed += _run.length;
+      } else if ((_y < _actual_size) && m_inserted[_y]) {
+        _run.kind = edit_kind::insert;
+        while ((_y < _actual_size) && m_inserted[_y]) {
+          ++_y;
+          ++_run.length;
+        }
+        p_diff.inserted += _run.length;
+      } else {
+        while ((_x < _expected_size) && (_y < _actual_size) &&
+               !m_removed[_x] && !m_inserted[_y]) {
+          ++_x;
+          ++_y;
+          ++_run.length;
+        }
+      }
+      p_diff.runs.push_back(_run);
+    }
+    p_diff.minimal = m_minimal;
+  }
+
+private:
+  bool equal(std::ptrdiff_t p_x, std::ptrdiff_t p_y) const {
+    return static_cast<bool>(m_expected[p_x] == m_actual[p_y]);
+  }
+
+  std::ptrdiff_t &forward(std::ptrdiff_t p_diagonal) {
+    return m_forward[static_cast<std::size_t>(p_diagonal + m_offset)];
+  }
+
+  std::ptrdiff_t &backward(std::ptrdiff_t p_diagonal) {
+    return m_backward[static_cast<std::size_t>(p_diagonal + m_offset)];
+  }
+
+  void compare(std::ptrdiff_t p_x_begin, std::ptrdiff_t p_x_end,
+               std::ptrdiff_t p_y_begin, std::ptrdiff_t p_y_end) {
+    while ((p_x_begin < p_x_end) && (p_y_begin < p_y_end) &&
+           equal(p_x_begin, p_y_begin)) {
+      ++p_x_begin;
+      ++p_y_begin;
+    }
+    while ((p_x_begin < p_x_end) && (p_y_begin < p_y_end) &&
+           equal(p_x_end - 1, p_y_end - 1)) {
+      --p_x_end;
+      --p_y_end;
+    }
+
+    if ((p_x_begin == p_x_end) || (p_y_begin == p_y_end)) {
+      for (std::ptrdiff_t _x = p_x_begin; _x < p_x_end; ++_x) {
+        m_removed[static_cast<std::size_t>(_x)] = 1;
+      }
+      for (std::ptrdiff_t _y = p_y_begin; _y < p_y_end; ++_y) {
+        m_inserted[static_cast<std::size_t>(_y)] = 1;
+      }
+      return;
+    }
+
+    const auto [_x_middle, _y_middle] =
+        middle_snake(p_x_begin, p_x_end, p_y_begin, p_y_end);
+    if (((_x_middle == p_x_begin) && (_y_middle == p_y_begin)) ||
+        ((_x_middle == p_x_end) && (_y_middle == p_y_end))) {
+      // no progress, which the heuristic should not allow; replaces
+      // everything, to be safe
+      m_minimal = false;
+      for (std::ptrdiff_t _x = p_x_begin; _x < p_x_end; ++_x) {
+        m_removed[static_cast<std::size_t>(_x)] = 1;
+      }
+      for (std::ptrdiff_t _y = p_y_begin; _y < p_y_end; ++_y) {
+        m_inserted[static_cast<std::size_t>(_y)] = 1;
+      }
+      return;
+    }
+    compare(p_x_begin, _x_middle, p_y_begin, _y_middle);
+    compare(_x_middle, p_x_end, _y_middle, p_y_end);
+  }
+
+  /// \return the point where the sequences are split
+  std::pair<std::ptrdiff_t, std::ptrdiff_t>
+  middle_snake(std::ptrdiff_t p_x_begin, std::ptrdiff_t p_x_end,
+               std::ptrdiff_t p_y_begin, std::ptrdiff_t p_y_end) {
+    constexpr std::ptrdiff_t _none{std::numeric_limits<std::ptrdiff_t>::max()};
+    const std::ptrdiff_t _diagonal_min{p_x_begin - p_y_end};
+    const std::ptrdiff_t _diagonal_max{p_x_end - p_y_begin};
+    const std::ptrdiff_t _forward_middle{p_x_begin - p_y_begin};
+    const std::ptrdiff_t _backward_middle{p_x_end - p_y_end};
+    const bool _odd{((_forward_middle - _backward_middle) & 1) != 0};
+
+    std::ptrdiff_t _forward_min{_forward_middle};
+    std::ptrdiff_t _forward_max{_forward_middle};
+    std::ptrdiff_t _backward_min{_backward_middle};
+    std::ptrdiff_t _backward_max{_backward_middle};
+    forward(_forward_middle) = p_x_begin;
+    backward(_backward_middle) = p_x_end;
+
+    for (std::ptrdiff_t _cost = 1;; ++_cost) {
+      if (_forward_min > _diagonal_min) {
+        forward(--_forward_min - 1) = -1;
+      } else {
+        ++_forward_min;
+      }
+      if (_forward_max < _diagonal_max) {
+        forward(++_forward_max + 1) = -1;
+      } else {
+        --_forward_max;
+      }
+      for (std::ptrdiff_t _d = _forward_max; _d >= _forward_min; _d -= 2) {
+        const std::ptrdiff_t _low{forward(_d - 1)};
+        const std::ptrdiff_t _high{forward(_d + 1)};
+        std::ptrdiff_t _x{_low >= _high ? _low + 1 : _high};
+        std::ptrdiff_t _y{_x - _d};
+        while ((_x < p_x_end) && (_y < p_y_end) && equal(_x, _y)) {
+          ++_x;
+          ++_y;
+        }
+        forward(_d) = _x;
+        if (_odd && (_backward_min <= _d) && (_d <= _backward_max) &&
+            (backward(_d) <= _x)) {
+          return {_x, _y};
+        }
+      }
+
+      if (_backward_min > _diagonal_min) {
+        backward(--_backward_min - 1) = _none;
+      } else {
+        ++_backward_min;
+      }
+      if (_backward_max < _diagonal_max) {
+        backward(++_backward_max + 1) = _none;
+      } else {
+        --_backward_max;
+      }
+      for (std::ptrdiff_t _d = _backward_max; _d >= _backward_min; _d -= 2) {
+        const std::ptrdiff_t _low{backward(_d - 1)};
+        const std::ptrdiff_t _high{backward(_d + 1)};
+        std::ptrdiff_t _x{_low < _high ? _low : _high - 1};
+        std::ptrdiff_t _y{_x - _d};
+        while ((_x > p_x_begin) && (_y > p_y_begin) && equal(_x - 1, _y - 1)) {
+          --_x;
+          --_y;
+        }
+        backward(_d) = _x;
+        if (!_odd && (_forward_min <= _d) && (_d <= _forward_max) &&
+            (_x <= forward(_d))) {
+          return {_x, _y};
+        }
+      }
+
+      if (_cost >= m_max_cost) {
+        m_minimal = false;
+        return furthest(p_x_begin, p_x_end, p_y_begin, p_y_end, _forward_min,
+                        _forward_max, _backward_min, _backward_max);
+      }
+    }
+  }
+
+  /// \return the point, reached forward or backward, that is the furthest
+  /// from where the search started
+  std::pair<std::ptrdiff_t, std::ptrdiff_t>
+  furthest(std::ptrdiff_t p_x_begin, std::ptrdiff_t p_x_end,
+           std::ptrdiff_t p_y_begin, std::ptrdiff_t p_y_end,
+           std::ptrdiff_t p_forward_min, std::ptrdiff_t p_forward_max,
+           std::ptrdiff_t p_backward_min, std::ptrdiff_t p_backward_max) {
+    std::ptrdiff_t _forward_sum{-1};
+    std::ptrdiff_t _forward_x{p_x_begin};
+    for (std::ptrdiff_t _d = p_forward_max; _d >= p_forward_min; _d -= 2) {
+      std::ptrdiff_t _x{std::min(forward(_d), p_x_end)};
+      std::ptrdiff_t _y{_x - _d};
+      if (_y > p_y_end) {
+        _x = p_y_end + _d;
+        _y = p_y_end;
+      }
+      if (_x + _y > _forward_sum) {
+        _forward_sum = _x + _y;
+        _forward_x = _x;
+      }
+    }
+
+    std::ptrdiff_t _backward_sum{std::numeric_limits<std::ptrdiff_t>::max()};
+    std::ptrdiff_t _backward_x{p_x_end};
+    for (std::ptrdiff_t _d = p_backward_max; _d >= p_backward_min; _d -= 2) {
+      std::ptrdiff_t _x{std::max(backward(_d), p_x_begin)};
+      std::ptrdiff_t _y{_x - _d};
+      if (_y < p_y_begin) {
+        _x = p_y_begin + _d;
+        _y = p_y_begin;
+      }
+      if (_x + _y < _backward_sum) {
+        _backward_sum = _x + _y;
+        _backward_x = _x;
+      }
+    }
+
+    if ((p_x_end + p_y_end) - _backward_sum <
+        _forward_sum - (p_x_begin + p_y_begin)) {
+      return {_forward_x, _forward_sum - _forward_x};
+    }
+    return {_backward_x, _backward_sum - _backward_x};
+  }
+
+private:
+  t_iterator m_expected;
+  t_iterator m_actual;
+
+  /// \brief If a value of the expected sequence was removed
+  std::vector<char> m_removed;
+
+  /// \brief If a value of the actual sequence was inserted
+  std::vector<char> m_inserted;
+
+  /// \brief Furthest x reached in each diagonal, searching forward and
+  /// backward
+  std::vector<std::ptrdiff_t> m_forward;
+  std::vector<std::ptrdiff_t> m_backward;
+
+  /// \brief Added to a diagonal, which can be negative, to index
+  /// \p m_forward and \p m_backward
+  std::ptrdiff_t m_offset;
+
+  std::ptrdiff_t m_max_cost;
+
+  bool m_minimal{true};
+};
+
+/// \brief Prints the value at \p p_index of \p p_sequence, in a line of a
+/// hunk
+template <typename t_sequence>
+void print_diff_line(std::ostream &p_out, char p_prefix,
+                     const t_sequence &p_sequence, std::size_t p_index) {
+  p_out << '\n' << p_prefix << " [" << p_index << "] ";
+  print_checked_value(p_out, *std::next(std::begin(p_sequence),
+                                        static_cast<std::ptrdiff_t>(p_index)));
+}
+
+} // namespace internal
+
+/// \brief Prints the runs of \p p_diff that differ, grouped in hunks with
+/// \p sequence_diff::context equal values around them
+template <typename t_sequence>
+std::ostream &operator<<(std::ostream &p_out,
+                         const sequence_diff<t_sequence> &p_diff) {
+  p_out << p_diff.removed << " removed, " << p_diff.inserted << " inserted";
+  if (!p_diff.minimal) {
+    p_out << ", not minimal";
+  }
+
+  const std::vector<edit_run> &_runs{p_diff.runs};
+  const std::size_t _context{p_diff.context};
+  std::size_t _lines{0};
+  std::size_t _run{0};
+  while (_run < _runs.size()) {
+    if (_runs[_run].kind == edit_kind::equal) {
+      ++_run;
+      continue;
+    }
+
+    // the hunk goes from '_run' to '_last', merging the changes separated by
+    // up to twice the context
+    std::size_t _last{_run};
+    while (_last + 1 < _runs.size()) {
+      const edit_run &_next{_runs[_last + 1]};
+      if (_next.kind != edit_kind::equal) {
+        ++_last;
+      } else if ((_last + 2 < _runs.size()) &&
+                 (_next.length <= 2 * _context)) {
+        _last += 2;
+      } else {
+        break;
+      }
+    }
+
+    const std::size_t _before{
+        (_run > 0) ? std::min(_context, _runs[_run - 1].length) : 0};
+    const std::size_t _after{(_last + 1 < _runs.size())
+                                 ? std::min(_context, _runs[_last + 1].length)
+                                 : 0};
+    const edit_run &_first_run{_runs[_run]};
+    const edit_run &_last_run{_runs[_last]};
+    const std::size_t _expected_begin{_first_run.expected_index - _before};
+    const std::size_t _actual_begin{_first_run.actual_index - _before};
+    const std::size_t _expected_end{
+        _last_run.expected_index +
+        (_last_run.kind == edit_kind::remove ? _last_run.length : 0) + _after};
+    const std::size_t _actual_end{
+        _last_run.actual_index +
+        (_last_run.kind == edit_kind::insert ? _last_run.length : 0) + _after};
+    p_out << "\n@@ -" << _expected_begin << ','
+          << _expected_end - _expected_begin << " +" << _actual_begin << ','
+          << _actual_end - _actual_begin << " @@";
+
+    auto _print = [&](char p_prefix, const t_sequence &p_sequence,
+                      std::size_t p_begin, std::size_t p_length) {
+      for (std::size_t _i = 0; _i < p_length; ++_i) {
+        if (_lines == p_diff.max_lines) {
+          return false;
+        }
+        internal::print_diff_line(p_out, p_prefix, p_sequence, p_begin + _i);
+        ++_lines;
+      }
+      return true;
+    };
+
+    bool _printing{_print(' ', p_diff.expected, _expected_begin, _before)};
+    for (std::size_t _i = _run; _printing && (_i <= _last); ++_i) {
+      const edit_run &_current{_runs[_i]};
+      switch (_current.kind) {
+      case edit_kind::remove:
+        _printing = _print('-', p_diff.expected, _current.expected_index,
+                           _current.length);
+        break;
+      case edit_kind::insert:
+        _printing = _print('+', p_diff.actual, _current.actual_index,
+                           _current.length);
+        break;
+      case edit_kind::equal:
+        _printing = _print(' ', p_diff.expected, _current.expected_index,
+                           _current.length);
+        break;
+      }
+    }
+    if (_printing) {
+      _printing = _print(' ', p_diff.expected, _expected_end - _after, _after);
+    }
+    if (!_printing) {
+      p_out << "\n...";
+      break;
+    }
+    _run = _last + 1;
+  }
+  return p_out;
+}
+
+/// \brief Computes the shortest edit script that transforms \p p_expected
+/// into \p p_actual, comparing the values with 'operator=='
+///
+/// \details The common prefix and suffix are skipped, and the remaining
+/// values are compared with the linear space variant of the algorithm of
+/// Myers, which takes time proportional to the number of values times the
+/// number of differences. To bound that time when the sequences are very
+/// different, the search for each split of the sequences stops after
+/// \p p_max_cost differences, and the script may not be the shortest.
+///
+/// \tparam t_sequence must have random access iterators, like 'std::vector',
+/// 'std::deque', 'std::array' or 'std::string'
+///
+/// \code
+/// struct test_parse_log {
+///   bool operator()(const program::alg::options &) {
+///     const std::vector<std::string> _expected{load("expected.txt")};
+///     const std::vector<std::string> _actual{parse(load("input.log"))};
+///     check_that(test::alg::diff_sequences(_expected, _actual));
+///     return true;
+///   }
+///
+///   static std::string desc() { return "parses a log"; }
+/// };
+/// \endcode
+template <typename t_sequence>
+sequence_diff<t_sequence> diff_sequences(const t_sequence &p_expected,
+                                         const t_sequence &p_actual,
+                                         std::size_t p_max_cost = 256) {
+  using iterator = decltype(std::begin(p_expected));
+  static_assert(
+      std::is_base_of_v<
+          std::random_access_iterator_tag,
+          typename std::iterator_traits<iterator>::iterator_category>,
+      "'diff_sequences' requires random access iterators");
+
+  sequence_diff<t_sequence> _diff{p_expected, p_actual};
+  const internal::myers_diff<iterator> _myers(
+      std::begin(p_expected), std::distance(std::begin(p_expected),
+                                            std::end(p_expected)),
+      std::begin(p_actual),
+      std::distance(std::begin(p_actual), std::end(p_actual)),
+      static_cast<std::ptrdiff_t>(p_max_cost));
+  _myers.script(_diff);
+  return _diff;
+}
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef TENACITAS_LIB_TEST_ALG_HOOK_ALLOCATOR_H
+#define TENACITAS_LIB_TEST_ALG_HOOK_ALLOCATOR_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+/// \brief Replaces the global allocation functions, allowing
+/// tenacitas::lib::test::alg::tester to count live allocations and to record
+/// where they were made
+///
+/// \attention Include this file in exactly ONE translation unit of the test
+/// program, usually the one that defines \p main. Without it, '--leak-check'
+/// has no effect. Call stacks are complete and have symbol names when the
+/// program is compiled with '-fno-omit-frame-pointer' and linked with
+/// '-rdynamic'.
+///
+/// \code
+/// #include <tenacitas.lib.test/alg/hook_allocator.h>
+/// #include <tenacitas.lib.test/alg/tester.h>
+/// \endcode
+
+#include <cstdlib>
+#include <new>
+
+#include <tenacitas.lib.test/alg/internal/alloc_hooks.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+inline void *hooked_alloc(std::size_t p_size, std::size_t p_align,
+                          bool p_throw, const void *p_frame) {
+  if (p_size == 0) {
+    p_size = 1;
+  }
+  for (;;) {
+    void *_ptr{nullptr};
+    if (p_align <= alignof(std::max_align_t)) {
+      _ptr = std::malloc(p_size);
+    } else if (posix_memalign(&_ptr, p_align, p_size) != 0) {
+      _ptr = nullptr;
+    }
+
+    if (_ptr != nullptr) {
+      alloc_hooks::on_alloc(_ptr, p_size, p_frame);
+      return _ptr;
+    }
+
+    std::new_handler _handler{std::get_new_handler()};
+    if (_handler == nullptr) {
+      if (p_throw) {
+        throw std::bad_alloc();
+      }
+      return nullptr;
+    }
+    _handler();
+  }
+}
+
+inline void hooked_free(void *p_ptr) noexcept {
+  if (p_ptr != nullptr) {
+    alloc_hooks::on_free(p_ptr);
+    std::free(p_ptr);
+  }
+}
+
+static const bool hook_allocator_installed{alloc_hooks::m_installed = true};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#define TENACITAS_LIB_TEST_ALLOC(size, align, throws)                          \
+  tenacitas::lib::test::alg::internal::hooked_alloc(                           \
+      size, align, throws, __builtin_frame_address(0))
+
+void *operator new(std::size_t p_size) {
+  return TENACITAS_LIB_TEST_ALLOC(p_size, 0, true);
+}
+
+void *operator new[](std::size_t p_size) {
+  return TENACITAS_LIB_TEST_ALLOC(p_size, 0, true);
+}
+
+void *operator new(std::size_t p_size, const std::nothrow_t &) noexcept {
+  try {
+    return TENACITAS_LIB_TEST_ALLOC(p_size, 0, false);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void *operator new[](std::size_t p_size, const std::nothrow_t &) noexcept {
+  try {
+    return TENACITAS_LIB_TEST_ALLOC(p_size, 0, false);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void *operator new(std::size_t p_size, std::align_val_t p_align) {
+  return TENACITAS_LIB_TEST_ALLOC(p_size, static_cast<std::size_t>(p_align),
+                                  true);
+}
+
+void *operator new[](std::size_t p_size, std::align_val_t p_align) {
+  return TENACITAS_LIB_TEST_ALLOC(p_size, static_cast<std::size_t>(p_align),
+                                  true);
+}
+
+void *operator new(std::size_t p_size, std::align_val_t p_align,
+                   const std::nothrow_t &) noexcept {
+  try {
+    return TENACITAS_LIB_TEST_ALLOC(p_size, static_cast<std::size_t>(p_align),
+                                    false);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void *operator new[](std::size_t p_size, std::align_val_t p_align,
+                     const std::nothrow_t &) noexcept {
+  try {
+    return TENACITAS_LIB_TEST_ALLOC(p_size, static_cast<std::size_t>(p_align),
+                                    false);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+#undef TENACITAS_LIB_TEST_ALLOC
+
+void operator delete(void *p_ptr) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete[](void *p_ptr) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete(void *p_ptr, std::size_t) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete[](void *p_ptr, std::size_t) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete(void *p_ptr, const std::nothrow_t &) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete[](void *p_ptr, const std::nothrow_t &) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete(void *p_ptr, std::align_val_t) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete[](void *p_ptr, std::align_val_t) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete(void *p_ptr, std::size_t, std::align_val_t) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete[](void *p_ptr, std::size_t, std::align_val_t) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete(void *p_ptr, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+void operator delete[](void *p_ptr, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+  tenacitas::lib::test::alg::internal::hooked_free(p_ptr);
+}
+
+#endif
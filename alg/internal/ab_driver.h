@@ -0,0 +1,271 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_AB_DRIVER_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_AB_DRIVER_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <tenacitas.lib.test/alg/internal/bench_stats.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Value of a string field in a JSON object printed in one line by
+/// \p print_json
+inline std::optional<std::string> json_string(const std::string &p_line,
+                                              const std::string &p_key) {
+  const std::string _pattern{'"' + p_key + "\":\""};
+  std::size_t _pos{p_line.find(_pattern)};
+  if (_pos == std::string::npos) {
+    return {};
+  }
+  std::string _value;
+  for (_pos += _pattern.size(); _pos < p_line.size(); ++_pos) {
+    if (p_line[_pos] == '\\') {
+      if (++_pos < p_line.size()) {
+        _value += p_line[_pos];
+      }
+    } else if (p_line[_pos] == '"') {
+      return _value;
+    } else {
+      _value += p_line[_pos];
+    }
+  }
+  return {};
+}
+
+/// \brief Value of a number field in a JSON object printed in one line by
+/// \p print_json
+inline std::optional<double> json_number(const std::string &p_line,
+                                         const std::string &p_key) {
+  const std::string _pattern{'"' + p_key + "\":"};
+  const std::size_t _pos{p_line.find(_pattern)};
+  if (_pos == std::string::npos) {
+    return {};
+  }
+  const char *_begin{p_line.c_str() + _pos + _pattern.size()};
+  char *_end{nullptr};
+  const double _value{std::strtod(_begin, &_end)};
+  if (_end == _begin) {
+    return {};
+  }
+  return _value;
+}
+
+/// \brief Executes a program pinned to a CPU, and returns its standard output
+/// split in lines
+///
+/// \param p_cpu CPU where the program runs; if negative, it is not pinned
+///
+/// \throw std::runtime_error if the program could not be executed, or if it
+/// did not finish normally
+inline std::vector<std::string>
+run_pinned(const std::string &p_program, const std::vector<std::string> &p_args,
+           int p_cpu) {
+  int _pipe[2];
+  if (pipe(_pipe) != 0) {
+    throw std::runtime_error(std::string{"could not create pipe: "} +
+                             std::strerror(errno));
+  }
+
+  std::vector<char *> _argv;
+  _argv.push_back(const_cast<char *>(p_program.c_str()));
+  for (const std::string &_arg : p_args) {
+    _argv.push_back(const_cast<char *>(_arg.c_str()));
+  }
+  _argv.push_back(nullptr);
+
+  const pid_t _pid{fork()};
+  if (_pid < 0) {
+    close(_pipe[0]);
+    close(_pipe[1]);
+    throw std::runtime_error(std::string{"could not fork: "} +
+                             std::strerror(errno));
+  }
+
+  if (_pid == 0) {
+    if (p_cpu >= 0) {
+      cpu_set_t _cpus;
+      CPU_ZERO(&_cpus);
+      CPU_SET(p_cpu, &_cpus);
+      sched_setaffinity(0, sizeof(_cpus), &_cpus);
+    }
+    dup2(_pipe[1], STDOUT_FILENO);
+    close(_pipe[0]);
+    close(_pipe[1]);
+    const int _null{open("/dev/null", O_WRONLY)};
+    if (_null >= 0) {
+      dup2(_null, STDERR_FILENO);
+    }
+    execv(p_program.c_str(), _argv.data());
+    _exit(127);
+  }
+
+  close(_pipe[1]);
+  std::vector<std::string> _lines;
+  std::string _cur;
+  char _buf[4096];
+  ssize_t _read{0};
+  while ((_read = read(_pipe[0], _buf, sizeof(_buf))) != 0) {
+    if (_read < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    for (ssize_t _i = 0; _i < _read; ++_i) {
+      if (_buf[_i] == '\n') {
+        _lines.push_back(std::move(_cur));
+        _cur.clear();
+      } else {
+        _cur += _buf[_i];
+      }
+    }
+  }
+  close(_pipe[0]);
+  if (!_cur.empty()) {
+    _lines.push_back(std::move(_cur));
+  }
+
+  int _status{0};
+  while ((waitpid(_pid, &_status, 0) < 0) && (errno == EINTR)) {
+  }
+  if (!WIFEXITED(_status) || (WEXITSTATUS(_status) == 127)) {
+    throw std::runtime_error("'" + p_program + "' did not finish normally");
+  }
+  return _lines;
+}
+
+/// \brief Alternates batches of benchmarks between two builds of the same
+/// test program, and compares the paired medians of each batch
+///
+/// \details Batch \p k executes the old build first if \p k is even, and the
+/// new build first otherwise, so that a drift of the machine affects both
+/// builds alike. Both builds run pinned to the same CPU.
+struct ab_driver {
+  /// \param p_old path of the old build
+  ///
+  /// \param p_new path of the new build
+  ///
+  /// \param p_args arguments passed to both builds, which must make them print
+  /// benchmark results with '--bench-json'
+  ///
+  /// \param p_batches number of batches executed by each build
+  ///
+  /// \param p_cpu CPU where the builds run; if negative, they are not pinned
+  ab_driver(const std::string &p_old, const std::string &p_new,
+            std::vector<std::string> &&p_args, std::size_t p_batches,
+            int p_cpu)
+      : m_old(p_old), m_new(p_new), m_args(std::move(p_args)),
+        m_batches(p_batches), m_cpu(p_cpu) {}
+
+  /// \brief Executes the batches and prints the comparison
+  void operator()(std::ostream &p_out) {
+    for (std::size_t _batch = 0; _batch < m_batches; ++_batch) {
+      if (_batch % 2 == 0) {
+        collect(m_old, true);
+        collect(m_new, false);
+      } else {
+        collect(m_new, false);
+        collect(m_old, true);
+      }
+    }
+    report(p_out);
+  }
+
+private:
+  /// \brief Median of each batch of a benchmark, for the old and new builds
+  struct samples {
+    std::vector<double> old_ns;
+    std::vector<double> new_ns;
+  };
+
+  void collect(const std::string &p_program, bool p_old) {
+    for (const std::string &_line : run_pinned(p_program, m_args, m_cpu)) {
+      if (_line.empty() || (_line.front() != '{')) {
+        continue;
+      }
+      std::optional<std::string> _name{json_string(_line, "name")};
+      std::optional<std::string> _mode{json_string(_line, "mode")};
+      std::optional<double> _median{json_number(_line, "median_ns")};
+      if (!_name || !_median) {
+        continue;
+      }
+      std::string _key{*_name};
+      if (_mode && (*_mode != "warm")) {
+        _key += " (" + *_mode + ')';
+      }
+      samples &_samples{m_samples[_key]};
+      (p_old ? _samples.old_ns : _samples.new_ns).push_back(*_median);
+    }
+  }
+
+  void report(std::ostream &p_out) const {
+    using namespace std;
+    size_t _width{12};
+    for (const auto &_value : m_samples) {
+      _width = max(_width, _value.first.size() + 2);
+    }
+
+    p_out << "A/B old '" << m_old << "', new '" << m_new << "' (" << m_batches
+          << " interleaved batches"
+          << (m_cpu >= 0 ? ", cpu " + to_string(m_cpu) : string{}) << ")\n"
+          << "  " << left << setw(static_cast<int>(_width)) << "benchmark"
+          << right << setw(14) << "old median" << setw(14) << "new median"
+          << setw(10) << "speedup" << "  95% interval\n";
+
+    for (const auto &_value : m_samples) {
+      const samples &_samples{_value.second};
+      vector<double> _old{_samples.old_ns};
+      vector<double> _new{_samples.new_ns};
+      const bench_speedup _speedup{compute_speedup(_old, _new)};
+      const bench_stats _old_stats{compute_stats(_old)};
+      const bench_stats _new_stats{compute_stats(_new)};
+
+      p_out << "  " << left << setw(static_cast<int>(_width)) << _value.first
+            << right << fixed << setprecision(1) << setw(14)
+            << _old_stats.median << setw(14) << _new_stats.median
+            << setprecision(3) << setw(10) << _speedup.value << "  ["
+            << _speedup.low << ", " << _speedup.high << "] " << defaultfloat;
+      if ((_old_stats.iterations < 2) || (_new_stats.iterations < 2)) {
+        p_out << "too few batches\n";
+      } else if (_speedup.low > 1.0) {
+        p_out << "FASTER\n";
+      } else if (_speedup.high < 1.0) {
+        p_out << "SLOWER\n";
+      } else {
+        p_out << "no significant difference\n";
+      }
+    }
+    p_out << flush;
+  }
+
+private:
+  std::string m_old;
+  std::string m_new;
+  std::vector<std::string> m_args;
+  std::size_t m_batches;
+  int m_cpu;
+  std::map<std::string, samples> m_samples;
+};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
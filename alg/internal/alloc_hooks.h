@@ -0,0 +1,205 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_ALLOC_HOOKS_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_ALLOC_HOOKS_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <malloc.h>
+
+#include <tenacitas.lib.test/alg/internal/heap_profile.h>
+#include <tenacitas.lib.test/alg/internal/stack_trace.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Allocation that was alive when a leak check was finished
+struct leak_entry {
+  std::atomic<void *> ptr{nullptr};
+  std::size_t size{0};
+  stack_trace stack;
+};
+
+/// \brief Fixed size lock free table of sampled allocations
+///
+/// \details Open addressing with linear probing; removed entries become
+/// tombstones that can be reused by later insertions. If no slot is found in
+/// \p max_probes attempts, the allocation is counted as dropped.
+struct leak_table {
+  static constexpr std::size_t capacity{8192};
+  static constexpr std::size_t max_probes{64};
+
+  void clear() {
+    for (leak_entry &_entry : m_entries) {
+      _entry.ptr.store(nullptr, std::memory_order_relaxed);
+    }
+    m_dropped.store(0, std::memory_order_relaxed);
+  }
+
+  void insert(void *p_ptr, std::size_t p_size, const void *p_frame) {
+    std::size_t _idx{index(p_ptr)};
+    for (std::size_t _probe = 0; _probe < max_probes; ++_probe) {
+      leak_entry &_entry{m_entries[(_idx + _probe) & (capacity - 1)]};
+      void *_cur{_entry.ptr.load(std::memory_order_relaxed)};
+      if (((_cur == nullptr) || (_cur == tombstone())) &&
+          _entry.ptr.compare_exchange_strong(_cur, p_ptr,
+                                             std::memory_order_acq_rel)) {
+        _entry.size = p_size;
+        capture_stack(_entry.stack, p_frame);
+        return;
+      }
+    }
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void erase(void *p_ptr) {
+    std::size_t _idx{index(p_ptr)};
+    for (std::size_t _probe = 0; _probe < max_probes; ++_probe) {
+      leak_entry &_entry{m_entries[(_idx + _probe) & (capacity - 1)]};
+      void *_cur{_entry.ptr.load(std::memory_order_relaxed)};
+      if (_cur == nullptr) {
+        return;
+      }
+      if ((_cur == p_ptr) &&
+          _entry.ptr.compare_exchange_strong(_cur, tombstone(),
+                                             std::memory_order_acq_rel)) {
+        return;
+      }
+    }
+  }
+
+  /// \brief Calls \p p_visitor for every allocation still in the table
+  ///
+  /// \details Must only be called when no thread is inserting or erasing
+  template <typename t_visitor> void for_each(t_visitor &&p_visitor) const {
+    for (const leak_entry &_entry : m_entries) {
+      void *_ptr{_entry.ptr.load(std::memory_order_acquire)};
+      if ((_ptr != nullptr) && (_ptr != tombstone())) {
+        p_visitor(_entry);
+      }
+    }
+  }
+
+  std::size_t dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  static void *tombstone() { return reinterpret_cast<void *>(1); }
+
+  static std::size_t index(void *p_ptr) {
+    auto _key = reinterpret_cast<std::uintptr_t>(p_ptr) >> 4;
+    return static_cast<std::size_t>(_key * 0x9E3779B97F4A7C15ULL >> 32) &
+           (capacity - 1);
+  }
+
+private:
+  leak_entry m_entries[capacity];
+  std::atomic<std::size_t> m_dropped{0};
+};
+
+/// \brief Number and size of live allocations at a given moment
+struct alloc_snapshot {
+  std::int64_t count{0};
+  std::int64_t bytes{0};
+};
+
+/// \brief Bookkeeping done by the replaced global allocation functions
+///
+/// \details The replacement functions themselves are defined in
+/// tenacitas.lib.test/alg/hook_allocator.h, which must be included in exactly
+/// one translation unit of the test program. Counting costs three relaxed atomic
+/// additions per allocation; call stacks are only captured while a leak check
+/// or a heap profile is running.
+struct alloc_hooks {
+  /// \param p_frame frame of the allocation function, from where the call
+  /// stack is unwound
+  static void on_alloc(void *p_ptr, std::size_t p_size, const void *p_frame) {
+    m_live_count.fetch_add(1, std::memory_order_relaxed);
+    m_total_count.fetch_add(1, std::memory_order_relaxed);
+    m_live_bytes.fetch_add(static_cast<std::int64_t>(malloc_usable_size(p_ptr)),
+                           std::memory_order_relaxed);
+
+    if (m_busy) {
+      return;
+    }
+    const bool _tracking{m_tracking.load(std::memory_order_relaxed)};
+    const bool _profiling{heap_profile::active()};
+    if (_tracking || _profiling) {
+      m_busy = true;
+      if (_tracking && (--m_countdown <= 0)) {
+        m_countdown = static_cast<std::int64_t>(
+            m_sample_period.load(std::memory_order_relaxed));
+        m_leaks.insert(p_ptr, p_size, p_frame);
+      }
+      if (_profiling) {
+        heap_profile::on_alloc(p_size, p_frame);
+      }
+      m_busy = false;
+    }
+  }
+
+  static void on_free(void *p_ptr) {
+    m_live_count.fetch_sub(1, std::memory_order_relaxed);
+    m_live_bytes.fetch_sub(static_cast<std::int64_t>(malloc_usable_size(p_ptr)),
+                           std::memory_order_relaxed);
+    if (m_tracking.load(std::memory_order_relaxed)) {
+      m_leaks.erase(p_ptr);
+    }
+  }
+
+  /// \brief Informs if hook_allocator.h was included in the program
+  static bool installed() { return m_installed; }
+
+  static alloc_snapshot snapshot() {
+    return {m_live_count.load(std::memory_order_acquire),
+            m_live_bytes.load(std::memory_order_acquire)};
+  }
+
+  /// \brief Number of allocations since the program started, including the
+  /// ones already released
+  static std::int64_t allocations() {
+    return m_total_count.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Starts recording the call stacks of new allocations
+  ///
+  /// \param p_sample_period one in every \p p_sample_period allocations, per
+  /// thread, has its call stack recorded
+  ///
+  /// \return the live allocations before the check starts
+  static alloc_snapshot start_leak_check(std::size_t p_sample_period) {
+    m_leaks.clear();
+    m_sample_period.store(p_sample_period == 0 ? 1 : p_sample_period,
+                          std::memory_order_relaxed);
+    m_countdown = 0;
+    m_tracking.store(true, std::memory_order_release);
+    return snapshot();
+  }
+
+  static void stop_leak_check() {
+    m_tracking.store(false, std::memory_order_release);
+  }
+
+  static const leak_table &leaks() { return m_leaks; }
+
+  static inline bool m_installed{false};
+
+private:
+  static inline std::atomic<std::int64_t> m_live_count{0};
+  static inline std::atomic<std::int64_t> m_live_bytes{0};
+  static inline std::atomic<std::int64_t> m_total_count{0};
+  static inline std::atomic<bool> m_tracking{false};
+  static inline std::atomic<std::size_t> m_sample_period{1};
+  static inline thread_local std::int64_t m_countdown{0};
+  static inline thread_local bool m_busy{false};
+  static inline leak_table m_leaks;
+};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_BENCH_REPORT_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_BENCH_REPORT_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <tenacitas.lib.test/alg/bench_state.h>
+#include <tenacitas.lib.test/alg/internal/bench_stats.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Value reported by a benchmark, normalized by time, iterations or
+/// threads
+struct bench_rate {
+  std::string name;
+  double value{0};
+  /// \brief Normalization of \p value: "/s", "/s/thread", "/iter" or ""
+  std::string suffix;
+  /// \brief Indicates that \p value is a per second rate, printed with SI
+  /// prefixes
+  bool per_second{false};
+};
+
+/// \brief Event counted by the hardware or the kernel during a benchmark
+struct bench_event {
+  std::string name;
+  bool available{false};
+  double per_iteration{0};
+};
+
+/// \brief Everything measured in one execution of a benchmark
+struct bench_result {
+  /// \brief "warm", "cold", or the name of the implementation in a family
+  std::string mode;
+  bench_stats stats;
+  std::vector<bench_rate> rates;
+  std::vector<bench_event> events;
+  /// \brief Speedup against the reference implementation of a family
+  std::optional<bench_speedup> speedup;
+};
+
+/// \brief Normalizes the bytes, items and named counters accumulated in \p
+/// p_state into rates
+template <typename t_driver>
+std::vector<bench_rate> make_rates(t_driver &p_state,
+                                   const bench_stats &p_stats) {
+  std::vector<bench_rate> _rates;
+  const double _seconds{p_stats.total / 1e9};
+  const double _iterations{static_cast<double>(p_stats.iterations)};
+  if ((_seconds <= 0) || (_iterations <= 0)) {
+    return _rates;
+  }
+
+  if (p_state.bytes() != 0) {
+    _rates.push_back(
+        {"bytes", static_cast<double>(p_state.bytes()) / _seconds, "/s", true});
+  }
+  if (p_state.items() != 0) {
+    _rates.push_back(
+        {"items", static_cast<double>(p_state.items()) / _seconds, "/s", true});
+  }
+
+  const double _threads{static_cast<double>(p_state.threads())};
+  p_state.for_each_counter([&](const bench_counter &p_counter) {
+    switch (p_counter.rate) {
+    case counter_rate::per_second:
+      _rates.push_back({p_counter.name, p_counter.value / _seconds, "/s", true});
+      break;
+    case counter_rate::per_iteration:
+      _rates.push_back(
+          {p_counter.name, p_counter.value / _iterations, "/iter", false});
+      break;
+    case counter_rate::per_thread:
+      _rates.push_back({p_counter.name, p_counter.value / _seconds / _threads,
+                        "/s/thread", true});
+      break;
+    case counter_rate::total:
+      _rates.push_back({p_counter.name, p_counter.value, "", false});
+      break;
+    }
+  });
+  return _rates;
+}
+
+/// \brief Prints \p p_value with a SI prefix, like "1.23 G"
+inline void print_si(std::ostream &p_out, double p_value) {
+  static const char *_prefixes[]{"", "k", "M", "G", "T", "P"};
+  std::size_t _idx{0};
+  while ((p_value >= 1000.0) && (_idx < 5)) {
+    p_value /= 1000.0;
+    ++_idx;
+  }
+  p_out << std::fixed << std::setprecision(2) << p_value << std::defaultfloat
+        << ' ' << _prefixes[_idx];
+}
+
+/// \brief Prints the rates and events of a result, one per line
+inline void print_rates_and_events(std::ostream &p_out,
+                                   const bench_result &p_result,
+                                   const std::string &p_prefix) {
+  for (const bench_rate &_rate : p_result.rates) {
+    p_out << "  " << p_prefix << _rate.name << ' ';
+    if (_rate.per_second) {
+      print_si(p_out, _rate.value);
+      p_out << (_rate.name == "bytes" ? "B" : _rate.name) << _rate.suffix;
+    } else {
+      p_out << std::fixed << std::setprecision(2) << _rate.value
+            << std::defaultfloat << _rate.suffix;
+    }
+    p_out << '\n';
+  }
+
+  for (const bench_event &_event : p_result.events) {
+    p_out << "  " << p_prefix << _event.name << ' ';
+    if (_event.available) {
+      p_out << std::fixed << std::setprecision(2) << _event.per_iteration
+            << std::defaultfloat << " per iteration\n";
+    } else {
+      p_out << "not available\n";
+    }
+  }
+}
+
+/// \brief Prints the results of a benchmark as text
+///
+/// \details One result is printed in one line; more results, like warm and
+/// cold cache, are printed side by side
+///
+/// \param p_note printed in the header when there is more than one result
+inline void print_text(std::ostream &p_out, std::string_view p_name,
+                       const std::vector<bench_result> &p_results,
+                       const std::string &p_note = "") {
+  using namespace std;
+  if (p_results.empty()) {
+    return;
+  }
+
+  if (p_results.size() == 1) {
+    const bench_stats &_stats{p_results.front().stats};
+    p_out << p_name << " BENCH" << fixed << setprecision(1) << " median "
+          << _stats.median << " ns, mean " << _stats.mean << " ns, min "
+          << _stats.min << " ns, p99 " << _stats.p99 << " ns, max "
+          << _stats.max << " ns (" << _stats.iterations << " iterations)"
+          << defaultfloat << '\n';
+    print_rates_and_events(p_out, p_results.front(), "");
+    p_out << flush;
+    return;
+  }
+
+  p_out << p_name << " BENCH (ns per iteration, "
+        << p_results.front().stats.iterations << " iterations"
+        << (p_note.empty() ? "" : ", ") << p_note << ")\n"
+        << "  " << setw(8) << ' ';
+  for (const bench_result &_result : p_results) {
+    p_out << setw(14) << _result.mode;
+  }
+  p_out << '\n';
+
+  auto _row = [&](const char *p_title, double bench_stats::*p_field) {
+    p_out << "  " << left << setw(8) << p_title << right << fixed
+          << setprecision(1);
+    for (const bench_result &_result : p_results) {
+      p_out << setw(14) << _result.stats.*p_field;
+    }
+    p_out << defaultfloat << '\n';
+  };
+  _row("median", &bench_stats::median);
+  _row("mean", &bench_stats::mean);
+  _row("min", &bench_stats::min);
+  _row("p99", &bench_stats::p99);
+  _row("max", &bench_stats::max);
+
+  for (const bench_result &_result : p_results) {
+    print_rates_and_events(p_out, _result, _result.mode + ' ');
+  }
+  p_out << flush;
+}
+
+/// \brief Prints the results of the implementations of a benchmark family,
+/// the first being the reference, as a table
+inline void print_family_text(std::ostream &p_out, std::string_view p_name,
+                              const std::vector<bench_result> &p_results) {
+  using namespace std;
+  if (p_results.empty()) {
+    return;
+  }
+
+  size_t _width{14};
+  for (const bench_result &_result : p_results) {
+    _width = max(_width, _result.mode.size() + 2);
+  }
+
+  p_out << p_name << " BENCH FAMILY (" << p_results.front().stats.iterations
+        << " interleaved rounds, reference " << p_results.front().mode
+        << ")\n"
+        << "  " << left << setw(static_cast<int>(_width)) << "implementation"
+        << right << setw(14) << "median ns" << setw(14) << "mean ns"
+        << setw(10) << "speedup" << "  95% interval\n";
+
+  for (const bench_result &_result : p_results) {
+    const bench_speedup _speedup{_result.speedup.value_or(bench_speedup{})};
+    p_out << "  " << left << setw(static_cast<int>(_width)) << _result.mode
+          << right << fixed << setprecision(1) << setw(14)
+          << _result.stats.median << setw(14) << _result.stats.mean
+          << setprecision(3) << setw(10) << _speedup.value << "  ["
+          << _speedup.low << ", " << _speedup.high << "]" << defaultfloat
+          << '\n';
+  }
+
+  for (const bench_result &_result : p_results) {
+    print_rates_and_events(p_out, _result, _result.mode + ' ');
+  }
+  p_out << flush;
+}
+
+/// \brief Prints \p p_text as a JSON string
+inline void print_json_string(std::ostream &p_out, std::string_view p_text) {
+  p_out << '"';
+  for (char _c : p_text) {
+    if ((_c == '"') || (_c == '\\')) {
+      p_out << '\\' << _c;
+    } else if (static_cast<unsigned char>(_c) < 0x20) {
+      p_out << ' ';
+    } else {
+      p_out << _c;
+    }
+  }
+  p_out << '"';
+}
+
+/// \brief Prints \p p_value as a JSON number, or 'null' if it is infinite or
+/// not a number, which JSON can not represent, like the rate of an iteration
+/// measured as 0 ns
+inline void print_json_number(std::ostream &p_out, double p_value) {
+  if (std::isfinite(p_value)) {
+    p_out << p_value;
+  } else {
+    p_out << "null";
+  }
+}
+
+/// \brief Prints a result of a benchmark as a JSON object in one line
+inline void print_json(std::ostream &p_out, std::string_view p_name,
+                       const bench_result &p_result) {
+  const bench_stats &_stats{p_result.stats};
+  const std::streamsize _precision{p_out.precision(17)};
+
+  p_out << "{\"name\":";
+  print_json_string(p_out, p_name);
+  p_out << ",\"mode\":";
+  print_json_string(p_out, p_result.mode);
+  p_out << ",\"iterations\":" << _stats.iterations << ",\"median_ns\":";
+  print_json_number(p_out, _stats.median);
+  p_out << ",\"mean_ns\":";
+  print_json_number(p_out, _stats.mean);
+  p_out << ",\"min_ns\":";
+  print_json_number(p_out, _stats.min);
+  p_out << ",\"p99_ns\":";
+  print_json_number(p_out, _stats.p99);
+  p_out << ",\"max_ns\":";
+  print_json_number(p_out, _stats.max);
+  p_out << ",\"stddev_ns\":";
+  print_json_number(p_out, _stats.stddev);
+  p_out << ",\"total_ns\":";
+  print_json_number(p_out, _stats.total);
+  if (p_result.speedup) {
+    p_out << ",\"speedup\":";
+    print_json_number(p_out, p_result.speedup->value);
+    p_out << ",\"speedup_low\":";
+    print_json_number(p_out, p_result.speedup->low);
+    p_out << ",\"speedup_high\":";
+    print_json_number(p_out, p_result.speedup->high);
+  }
+  p_out << ",\"rates\":{";
+
+  bool _first{true};
+  for (const bench_rate &_rate : p_result.rates) {
+    p_out << (_first ? "" : ",");
+    print_json_string(p_out, _rate.name + _rate.suffix);
+    p_out << ':';
+    print_json_number(p_out, _rate.value);
+    _first = false;
+  }
+  p_out << "},\"events\":{";
+
+  _first = true;
+  for (const bench_event &_event : p_result.events) {
+    p_out << (_first ? "" : ",");
+    print_json_string(p_out, _event.name);
+    p_out << ':';
+    if (_event.available) {
+      print_json_number(p_out, _event.per_iteration);
+    } else {
+      p_out << "null";
+    }
+    _first = false;
+  }
+  p_out << "}}" << std::endl;
+  p_out.precision(_precision);
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_BENCH_STATS_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_BENCH_STATS_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Summary of the time, in nanoseconds, taken by the iterations of a
+/// benchmark
+struct bench_stats {
+  std::size_t iterations{0};
+  double min{0};
+  double median{0};
+  double mean{0};
+  double p99{0};
+  double max{0};
+  double stddev{0};
+  /// \brief Sum of the time of all the iterations
+  double total{0};
+};
+
+/// \brief How many times an implementation is faster than a reference, with
+/// a 95% confidence interval
+struct bench_speedup {
+  double value{1};
+  double low{1};
+  double high{1};
+};
+
+/// \brief Two sided 95% critical value of the Student's t distribution with
+/// \p p_degrees degrees of freedom
+inline double t_critical_95(std::size_t p_degrees) {
+  static constexpr double _table[]{12.706, 4.303, 3.182, 2.776, 2.571, 2.447,
+                                   2.365,  2.306, 2.262, 2.228, 2.201, 2.179,
+                                   2.160,  2.145, 2.131, 2.120, 2.110, 2.101,
+                                   2.093,  2.086, 2.080, 2.074, 2.069, 2.064,
+                                   2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+  if (p_degrees == 0) {
+    return 0;
+  }
+  if (p_degrees <= 30) {
+    return _table[p_degrees - 1];
+  }
+  return p_degrees <= 120 ? 2.0 : 1.96;
+}
+
+/// \brief Computes the speedup from paired samples
+///
+/// \details \p p_reference[i] and \p p_other[i] must have been measured in
+/// the same round. The speedup is the geometric mean of the ratios
+/// reference/other, and the interval comes from the Student's t distribution
+/// of the mean of the log of the ratios
+inline bench_speedup compute_speedup(const std::vector<double> &p_reference,
+                                     const std::vector<double> &p_other) {
+  bench_speedup _speedup;
+  const std::size_t _n{std::min(p_reference.size(), p_other.size())};
+  if (_n == 0) {
+    return _speedup;
+  }
+
+  std::vector<double> _logs;
+  _logs.reserve(_n);
+  for (std::size_t _i = 0; _i < _n; ++_i) {
+    if ((p_reference[_i] > 0) && (p_other[_i] > 0)) {
+      _logs.push_back(std::log(p_reference[_i] / p_other[_i]));
+    }
+  }
+  if (_logs.empty()) {
+    return _speedup;
+  }
+
+  const double _count{static_cast<double>(_logs.size())};
+  const double _mean{std::accumulate(_logs.begin(), _logs.end(), 0.0) /
+                     _count};
+  double _sq{0};
+  for (double _log : _logs) {
+    _sq += (_log - _mean) * (_log - _mean);
+  }
+  const double _margin{
+      _logs.size() > 1 ? t_critical_95(_logs.size() - 1) *
+                             std::sqrt(_sq / (_count - 1)) / std::sqrt(_count)
+                       : 0.0};
+
+  _speedup.value = std::exp(_mean);
+  _speedup.low = std::exp(_mean - _margin);
+  _speedup.high = std::exp(_mean + _margin);
+  return _speedup;
+}
+
+/// \brief Computes the summary of \p p_ns, which is sorted
+inline bench_stats compute_stats(std::vector<double> &p_ns) {
+  bench_stats _stats;
+  if (p_ns.empty()) {
+    return _stats;
+  }
+
+  std::sort(p_ns.begin(), p_ns.end());
+  const std::size_t _n{p_ns.size()};
+
+  _stats.iterations = _n;
+  _stats.min = p_ns.front();
+  _stats.max = p_ns.back();
+  _stats.median = (_n % 2 == 1) ? p_ns[_n / 2]
+                                : (p_ns[_n / 2 - 1] + p_ns[_n / 2]) / 2.0;
+  _stats.p99 = p_ns[std::min(_n - 1, (_n * 99) / 100)];
+  _stats.total = std::accumulate(p_ns.begin(), p_ns.end(), 0.0);
+  _stats.mean = _stats.total / static_cast<double>(_n);
+
+  double _sq{0};
+  for (double _ns : p_ns) {
+    _sq += (_ns - _stats.mean) * (_ns - _stats.mean);
+  }
+  _stats.stddev =
+      _n > 1 ? std::sqrt(_sq / static_cast<double>(_n - 1)) : 0.0;
+
+  return _stats;
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
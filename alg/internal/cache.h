@@ -0,0 +1,117 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_CACHE_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_CACHE_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Size of the cache line assumed when walking through memory
+static constexpr std::size_t cache_line_size{64};
+
+/// \brief Size, in bytes, of the last level data cache of the first CPU
+///
+/// \details Read from '/sys/devices/system/cpu/cpu0/cache/index<n>', where the
+/// cache with the highest 'level' that is not an 'Instruction' cache is
+/// chosen. If nothing can be read, 32 MiB is assumed.
+inline std::size_t last_level_cache_size() {
+  const std::string _base{"/sys/devices/system/cpu/cpu0/cache/index"};
+  std::size_t _size{0};
+  int _level{0};
+
+  for (int _idx = 0;; ++_idx) {
+    const std::string _dir{_base + std::to_string(_idx) + '/'};
+    std::ifstream _level_file{_dir + "level"};
+    if (!_level_file) {
+      break;
+    }
+    int _cur_level{0};
+    _level_file >> _cur_level;
+
+    std::string _type;
+    std::ifstream{_dir + "type"} >> _type;
+    if (_type == "Instruction") {
+      continue;
+    }
+
+    std::string _text;
+    std::ifstream{_dir + "size"} >> _text;
+    if (_text.empty() || (_cur_level < _level)) {
+      continue;
+    }
+
+    std::size_t _cur_size{std::stoul(_text)};
+    switch (_text.back()) {
+    case 'K':
+      _cur_size *= 1024;
+      break;
+    case 'M':
+      _cur_size *= 1024 * 1024;
+      break;
+    case 'G':
+      _cur_size *= 1024 * 1024 * 1024;
+      break;
+    default:
+      break;
+    }
+    _level = _cur_level;
+    _size = _cur_size;
+  }
+
+  return _size != 0 ? _size : 32 * 1024 * 1024;
+}
+
+/// \brief How many times larger than the last level cache the buffer of a
+/// \p cache_evictor is, by default
+///
+/// \details Streaming through as many bytes as the cache holds does not evict
+/// all of it when the cache is not inclusive, as in many server CPUs, or when
+/// its replacement policy adapts to streaming, keeping part of the old lines
+static constexpr std::size_t cache_eviction_factor{3};
+
+/// \brief Removes from the caches the data used by a benchmark, by streaming
+/// through a buffer larger than the last level cache
+struct cache_evictor {
+  /// \param p_size size of the buffer; if 0, \p cache_eviction_factor times
+  /// the size of the last level cache
+  explicit cache_evictor(std::size_t p_size = 0)
+      : m_size(p_size != 0 ? p_size
+                           : cache_eviction_factor * last_level_cache_size()),
+        m_buffer(new std::uint8_t[m_size]) {
+    for (std::size_t _i = 0; _i < m_size; _i += cache_line_size) {
+      m_buffer[_i] = static_cast<std::uint8_t>(_i);
+    }
+  }
+
+  cache_evictor(const cache_evictor &) = delete;
+  cache_evictor &operator=(const cache_evictor &) = delete;
+
+  /// \brief Reads and writes one byte of each cache line of the buffer
+  void operator()() {
+    std::uint8_t _acc{0};
+    for (std::size_t _i = 0; _i < m_size; _i += cache_line_size) {
+      _acc += m_buffer[_i];
+      m_buffer[_i] = _acc;
+    }
+    m_sink = _acc;
+  }
+
+  std::size_t size() const { return m_size; }
+
+private:
+  std::size_t m_size;
+  std::unique_ptr<std::uint8_t[]> m_buffer;
+  volatile std::uint8_t m_sink{0};
+};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_DATASET_DIRECTORY_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_DATASET_DIRECTORY_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cstdlib>
+#include <string>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Directory passed with '--dataset-cache'; if empty,
+/// \p default_dataset_directory is used
+inline std::string dataset_directory;
+
+/// \brief '$TMPDIR/tenacitas.lib.test.datasets', or
+/// '/tmp/tenacitas.lib.test.datasets'
+inline std::string default_dataset_directory() {
+  const char *_tmp{std::getenv("TMPDIR")};
+  return std::string{((_tmp != nullptr) && (*_tmp != '\0')) ? _tmp : "/tmp"} +
+         "/tenacitas.lib.test.datasets";
+}
+
+inline std::string current_dataset_directory() {
+  return dataset_directory.empty() ? default_dataset_directory()
+                                   : dataset_directory;
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_HEAP_PROFILE_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_HEAP_PROFILE_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <tenacitas.lib.test/alg/internal/stack_trace.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Allocation site, identified by its call stack, and the estimated
+/// amount of memory allocated from it
+struct heap_site {
+  std::atomic<std::uint64_t> hash{0};
+  stack_trace stack;
+  std::atomic<std::uint64_t> samples{0};
+  std::atomic<std::uint64_t> bytes{0};
+  std::atomic<std::uint64_t> count{0};
+};
+
+/// \brief Fixed size lock free table of allocation sites
+///
+/// \details The site is found by the hash of its call stack, with linear
+/// probing. The thread that claims an empty slot writes the call stack; the
+/// counters are atomically incremented by any thread.
+struct heap_site_table {
+  static constexpr std::size_t capacity{4096};
+  static constexpr std::size_t max_probes{64};
+
+  void clear() {
+    for (heap_site &_site : m_sites) {
+      _site.hash.store(0, std::memory_order_relaxed);
+      _site.samples.store(0, std::memory_order_relaxed);
+      _site.bytes.store(0, std::memory_order_relaxed);
+      _site.count.store(0, std::memory_order_relaxed);
+    }
+    m_dropped.store(0, std::memory_order_relaxed);
+  }
+
+  void add(const stack_trace &p_stack, std::uint64_t p_bytes,
+           std::uint64_t p_count) {
+    const std::uint64_t _hash{hash(p_stack)};
+    for (std::size_t _probe = 0; _probe < max_probes; ++_probe) {
+      heap_site &_site{m_sites[(_hash + _probe) & (capacity - 1)]};
+      std::uint64_t _cur{_site.hash.load(std::memory_order_acquire)};
+      if (_cur == 0) {
+        if (_site.hash.compare_exchange_strong(_cur, _hash,
+                                               std::memory_order_acq_rel)) {
+          _site.stack = p_stack;
+          _cur = _hash;
+        }
+      }
+      if (_cur == _hash) {
+        _site.samples.fetch_add(1, std::memory_order_relaxed);
+        _site.bytes.fetch_add(p_bytes, std::memory_order_relaxed);
+        _site.count.fetch_add(p_count, std::memory_order_relaxed);
+        return;
+      }
+    }
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// \brief Calls \p p_visitor for every site
+  ///
+  /// \details Must only be called when no thread is adding samples
+  template <typename t_visitor> void for_each(t_visitor &&p_visitor) const {
+    for (const heap_site &_site : m_sites) {
+      if (_site.hash.load(std::memory_order_acquire) != 0) {
+        p_visitor(_site);
+      }
+    }
+  }
+
+  std::size_t dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  static std::uint64_t hash(const stack_trace &p_stack) {
+    std::uint64_t _hash{0xCBF29CE484222325ULL};
+    for (std::uint8_t _i = 0; _i < p_stack.size; ++_i) {
+      _hash ^= reinterpret_cast<std::uintptr_t>(p_stack.frames[_i]);
+      _hash *= 0x100000001B3ULL;
+      _hash ^= _hash >> 29;
+    }
+    return _hash == 0 ? 1 : _hash;
+  }
+
+private:
+  heap_site m_sites[capacity];
+  std::atomic<std::size_t> m_dropped{0};
+};
+
+/// \brief Sampling heap profiler
+///
+/// \details Each thread samples the allocation that crosses a random number of
+/// allocated bytes, exponentially distributed with mean \p m_interval, so the
+/// sampling points form a Poisson process over the bytes allocated. An
+/// allocation of \p s bytes is sampled with probability 1 - exp(-s/interval),
+/// so each sample is weighted by the inverse of that probability. Allocations
+/// that are not sampled cost one thread local subtraction.
+struct heap_profile {
+  static bool active() { return m_active.load(std::memory_order_relaxed); }
+
+  static void on_alloc(std::size_t p_size, const void *p_frame) {
+    const std::uint64_t _generation{
+        m_generation.load(std::memory_order_relaxed)};
+    if (m_generation_seen != _generation) {
+      m_generation_seen = _generation;
+      m_countdown = next_interval();
+    }
+    if (static_cast<std::int64_t>(p_size) < m_countdown) {
+      m_countdown -= static_cast<std::int64_t>(p_size);
+      return;
+    }
+    m_countdown = next_interval();
+
+    const double _interval{
+        static_cast<double>(m_interval.load(std::memory_order_relaxed))};
+    const double _size{static_cast<double>(p_size)};
+    const double _probability{1.0 - std::exp(-_size / _interval)};
+
+    stack_trace _stack;
+    capture_stack(_stack, p_frame);
+    m_sites.add(_stack, static_cast<std::uint64_t>(_size / _probability),
+                static_cast<std::uint64_t>(1.0 / _probability + 0.5));
+  }
+
+  /// \brief Starts collecting samples
+  ///
+  /// \param p_interval average number of bytes allocated between two samples
+  static void start(std::size_t p_interval) {
+    m_sites.clear();
+    m_interval.store(p_interval == 0 ? 1 : p_interval,
+                     std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+    m_active.store(true, std::memory_order_release);
+  }
+
+  static void stop() { m_active.store(false, std::memory_order_release); }
+
+  /// \brief Sites with most estimated bytes and with most estimated
+  /// allocations
+  ///
+  /// \details Must only be called after \p stop
+  static void top(std::size_t p_n, std::vector<const heap_site *> &p_by_bytes,
+                  std::vector<const heap_site *> &p_by_count) {
+    p_by_bytes.clear();
+    m_sites.for_each(
+        [&](const heap_site &p_site) { p_by_bytes.push_back(&p_site); });
+    p_by_count = p_by_bytes;
+
+    auto _top = [p_n](std::vector<const heap_site *> &p_sites,
+                      auto p_counter) {
+      const std::size_t _n{std::min(p_n, p_sites.size())};
+      std::partial_sort(p_sites.begin(), p_sites.begin() + _n, p_sites.end(),
+                        [p_counter](const heap_site *p_a,
+                                    const heap_site *p_b) {
+                          return (p_a->*p_counter).load() >
+                                 (p_b->*p_counter).load();
+                        });
+      p_sites.resize(_n);
+    };
+    _top(p_by_bytes, &heap_site::bytes);
+    _top(p_by_count, &heap_site::count);
+  }
+
+  /// \brief Estimated bytes and allocations of all the sites
+  ///
+  /// \details Must only be called after \p stop
+  static void totals(std::uint64_t &p_bytes, std::uint64_t &p_count) {
+    p_bytes = 0;
+    p_count = 0;
+    m_sites.for_each([&](const heap_site &p_site) {
+      p_bytes += p_site.bytes.load(std::memory_order_relaxed);
+      p_count += p_site.count.load(std::memory_order_relaxed);
+    });
+  }
+
+  static std::size_t dropped() { return m_sites.dropped(); }
+
+private:
+  /// \brief Exponentially distributed number of bytes until the next sample,
+  /// using a thread local xorshift generator
+  static std::int64_t next_interval() {
+    if (m_rand == 0) {
+      m_rand =
+          reinterpret_cast<std::uintptr_t>(&m_rand) ^ 0x2545F4914F6CDD1DULL;
+    }
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 7;
+    m_rand ^= m_rand << 17;
+    const double _uniform{static_cast<double>((m_rand >> 11) + 1) /
+                          static_cast<double>(1ULL << 53)};
+    const double _bytes{
+        -std::log(_uniform) *
+        static_cast<double>(m_interval.load(std::memory_order_relaxed))};
+    return std::max<std::int64_t>(1, static_cast<std::int64_t>(_bytes));
+  }
+
+private:
+  static inline std::atomic<bool> m_active{false};
+  static inline std::atomic<std::size_t> m_interval{512 * 1024};
+  static inline std::atomic<std::uint64_t> m_generation{0};
+  static inline thread_local std::uint64_t m_generation_seen{0};
+  static inline thread_local std::uint64_t m_rand{0};
+  static inline thread_local std::int64_t m_countdown{0};
+  static inline heap_site_table m_sites;
+};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
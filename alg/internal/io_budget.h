@@ -0,0 +1,93 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_IO_BUDGET_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_IO_BUDGET_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Number of counters read from '/proc/self/io'
+static constexpr std::size_t num_io_counters{6};
+
+/// \brief Budgets of a test for the counters of '/proc/self/io'
+using io_budget = std::array<std::optional<std::uint64_t>, num_io_counters>;
+
+/// \brief 't_test_class::max_rchar', if it is defined
+template <typename t_test_class, typename = void> struct io_max_rchar {
+  static constexpr std::optional<std::uint64_t> value{};
+};
+template <typename t_test_class>
+struct io_max_rchar<t_test_class, std::void_t<decltype(t_test_class::max_rchar)>> {
+  static constexpr std::optional<std::uint64_t> value{t_test_class::max_rchar};
+};
+
+/// \brief 't_test_class::max_wchar', if it is defined
+template <typename t_test_class, typename = void> struct io_max_wchar {
+  static constexpr std::optional<std::uint64_t> value{};
+};
+template <typename t_test_class>
+struct io_max_wchar<t_test_class, std::void_t<decltype(t_test_class::max_wchar)>> {
+  static constexpr std::optional<std::uint64_t> value{t_test_class::max_wchar};
+};
+
+/// \brief 't_test_class::max_syscr', if it is defined
+template <typename t_test_class, typename = void> struct io_max_syscr {
+  static constexpr std::optional<std::uint64_t> value{};
+};
+template <typename t_test_class>
+struct io_max_syscr<t_test_class, std::void_t<decltype(t_test_class::max_syscr)>> {
+  static constexpr std::optional<std::uint64_t> value{t_test_class::max_syscr};
+};
+
+/// \brief 't_test_class::max_syscw', if it is defined
+template <typename t_test_class, typename = void> struct io_max_syscw {
+  static constexpr std::optional<std::uint64_t> value{};
+};
+template <typename t_test_class>
+struct io_max_syscw<t_test_class, std::void_t<decltype(t_test_class::max_syscw)>> {
+  static constexpr std::optional<std::uint64_t> value{t_test_class::max_syscw};
+};
+
+/// \brief 't_test_class::max_read_bytes', if it is defined
+template <typename t_test_class, typename = void> struct io_max_read_bytes {
+  static constexpr std::optional<std::uint64_t> value{};
+};
+template <typename t_test_class>
+struct io_max_read_bytes<t_test_class,
+                         std::void_t<decltype(t_test_class::max_read_bytes)>> {
+  static constexpr std::optional<std::uint64_t> value{
+      t_test_class::max_read_bytes};
+};
+
+/// \brief 't_test_class::max_write_bytes', if it is defined
+template <typename t_test_class, typename = void> struct io_max_write_bytes {
+  static constexpr std::optional<std::uint64_t> value{};
+};
+template <typename t_test_class>
+struct io_max_write_bytes<t_test_class,
+                          std::void_t<decltype(t_test_class::max_write_bytes)>> {
+  static constexpr std::optional<std::uint64_t> value{
+      t_test_class::max_write_bytes};
+};
+
+/// \brief Budgets of a test class, in the order of \p io_counter_names
+template <typename t_test_class> constexpr io_budget io_budgets() {
+  return {io_max_rchar<t_test_class>::value,
+          io_max_wchar<t_test_class>::value,
+          io_max_syscr<t_test_class>::value,
+          io_max_syscw<t_test_class>::value,
+          io_max_read_bytes<t_test_class>::value,
+          io_max_write_bytes<t_test_class>::value};
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_IO_STATS_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_IO_STATS_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <tenacitas.lib.test/alg/internal/io_budget.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Names of the counters read from '/proc/self/io'
+static constexpr std::array<const char *, num_io_counters> io_counter_names{
+    "rchar", "wchar", "syscr", "syscw", "read_bytes", "write_bytes"};
+
+/// \brief I/O counters of the process at a moment
+///
+/// \details It does not allocate memory, so it can be taken while allocations
+/// are being checked
+struct io_snapshot {
+  /// \brief Reads '/proc/self/io'
+  void take() {
+    m_available = false;
+    const int _fd{open("/proc/self/io", O_RDONLY)};
+    if (_fd < 0) {
+      return;
+    }
+    char _buf[512];
+    const ssize_t _read{read(_fd, _buf, sizeof(_buf) - 1)};
+    close(_fd);
+    if (_read <= 0) {
+      return;
+    }
+    _buf[_read] = '\0';
+
+    for (std::size_t _i = 0; _i < num_io_counters; ++_i) {
+      m_values[_i] = 0;
+      const std::size_t _len{std::strlen(io_counter_names[_i])};
+      for (const char *_line = _buf; _line != nullptr;
+           _line = std::strchr(_line, '\n')) {
+        if (*_line == '\n') {
+          ++_line;
+        }
+        if ((std::strncmp(_line, io_counter_names[_i], _len) == 0) &&
+            (_line[_len] == ':')) {
+          m_values[_i] = std::strtoull(_line + _len + 1, nullptr, 10);
+          break;
+        }
+      }
+    }
+    m_available = true;
+  }
+
+  /// \brief Informs if '/proc/self/io' could be read
+  bool available() const { return m_available; }
+
+  /// \brief Value of the counter at \p p_idx of \p io_counter_names
+  std::uint64_t operator[](std::size_t p_idx) const { return m_values[p_idx]; }
+
+private:
+  std::array<std::uint64_t, num_io_counters> m_values{};
+  bool m_available{false};
+};
+
+/// \brief Counters incremented by \p io_snapshot::take itself, measured once
+inline const std::array<std::uint64_t, num_io_counters> &io_snapshot_cost() {
+  static const std::array<std::uint64_t, num_io_counters> _cost{[]() {
+    io_snapshot _first;
+    io_snapshot _second;
+    _first.take();
+    _second.take();
+    std::array<std::uint64_t, num_io_counters> _delta{};
+    for (std::size_t _i = 0; _i < num_io_counters; ++_i) {
+      _delta[_i] = _second[_i] - _first[_i];
+    }
+    return _delta;
+  }()};
+  return _cost;
+}
+
+/// \brief Prints the I/O done by a test, and the budgets it exceeded
+///
+/// \details The I/O of reading '/proc/self/io' is discounted. Nothing is
+/// printed if the test did no I/O and has no budget
+///
+/// \return \p true if no budget was exceeded
+inline bool print_io(
+    std::ostream &p_out, std::string_view p_name, const io_snapshot &p_before,
+    const io_snapshot &p_after, const io_budget &p_budgets) {
+  if (!p_before.available() || !p_after.available()) {
+    return true;
+  }
+
+  const std::array<std::uint64_t, num_io_counters> &_cost{io_snapshot_cost()};
+  std::array<std::uint64_t, num_io_counters> _deltas{};
+  bool _any{false};
+  for (std::size_t _i = 0; _i < num_io_counters; ++_i) {
+    const std::uint64_t _delta{p_after[_i] - p_before[_i]};
+    _deltas[_i] = (_delta > _cost[_i] ? _delta - _cost[_i] : 0);
+    _any = _any || p_budgets[_i] || (_deltas[_i] != 0);
+  }
+  if (!_any) {
+    return true;
+  }
+
+  bool _within{true};
+  p_out << "IO for " << p_name << ':';
+  for (std::size_t _i = 0; _i < num_io_counters; ++_i) {
+    p_out << (_i == 0 ? " " : ", ") << io_counter_names[_i] << ' '
+          << _deltas[_i];
+  }
+  p_out << '\n';
+
+  for (std::size_t _i = 0; _i < num_io_counters; ++_i) {
+    if (p_budgets[_i] && (_deltas[_i] > *p_budgets[_i])) {
+      p_out << "IO BUDGET EXCEEDED for " << p_name << ": "
+            << io_counter_names[_i] << ' ' << _deltas[_i] << " > max_"
+            << io_counter_names[_i] << ' ' << *p_budgets[_i] << '\n';
+      _within = false;
+    }
+  }
+  p_out << std::flush;
+  return _within;
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
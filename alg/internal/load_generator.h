@@ -0,0 +1,282 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_LOAD_GENERATOR_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_LOAD_GENERATOR_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <list>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <tenacitas.lib.program/alg/options.h>
+#include <tenacitas.lib.test/alg/internal/bench_report.h>
+#include <tenacitas.lib.test/alg/internal/latency_histogram.h>
+#include <tenacitas.lib.test/alg/internal/tsc.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Result of calling a benchmark at a target rate
+struct load_point {
+  /// \brief Calls per second requested
+  double target{0};
+  /// \brief Calls per second completed
+  double achieved{0};
+  /// \brief Time from the intended start of each call to its completion
+  latency_histogram latency;
+};
+
+/// \brief Options of the benchmarks executed with 'run_load'
+struct load_settings {
+  /// \brief Reads the options described in the constructor of
+  /// tenacitas::lib::test::alg::tester
+  ///
+  /// \throw std::invalid_argument if a rate is not a positive number
+  static load_settings parse(const program::alg::options &p_options) {
+    load_settings _settings;
+    std::optional<std::list<program::alg::options::value>> _maybe_rates =
+        p_options.get_set_param("load-rates");
+    if (_maybe_rates) {
+      for (const program::alg::options::value &_rate : *_maybe_rates) {
+        const double _calls_per_second{std::stod(_rate)};
+        if (!std::isfinite(_calls_per_second) || (_calls_per_second <= 0)) {
+          throw std::invalid_argument("'--load-rates' must be positive "
+                                      "calls per second, not '" +
+                                      _rate + "'");
+        }
+        _settings.rates.push_back(_calls_per_second);
+      }
+    }
+    std::optional<program::alg::options::value> _maybe_duration =
+        p_options.get_single_param("load-duration");
+    if (_maybe_duration) {
+      _settings.duration =
+          std::chrono::milliseconds(std::stol(*_maybe_duration));
+    }
+    return _settings;
+  }
+
+  /// \brief Calls per second of each step; if empty, fractions of the rate
+  /// achieved in closed loop are used
+  std::vector<double> rates;
+
+  /// \brief Time each rate is sustained
+  std::chrono::milliseconds duration{1000};
+};
+
+/// \brief Tells the processor that the thread is spinning, and gives the
+/// processor to other threads every 64 spins, so that spinning threads do
+/// not starve each other when they share a processor
+inline void spin_pause(std::size_t &p_spins) {
+  if ((++p_spins % 64) == 0) {
+    std::this_thread::yield();
+    return;
+  }
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+/// \brief Waits until \p tsc reaches \p p_ticks, sleeping while it is far,
+/// and spinning in the last 100 microseconds
+inline void wait_until_tsc(std::uint64_t p_ticks, double p_ticks_per_ns,
+                           const std::atomic<bool> &p_stop) {
+  const double _spin_ticks{100000.0 * p_ticks_per_ns};
+  std::size_t _spins{0};
+  for (std::uint64_t _now = tsc(); (_now < p_ticks) && !p_stop.load();
+       _now = tsc()) {
+    const double _left{static_cast<double>(p_ticks - _now)};
+    if (_left > 2 * _spin_ticks) {
+      std::this_thread::sleep_for(std::chrono::nanoseconds(
+          static_cast<std::int64_t>((_left - _spin_ticks) / p_ticks_per_ns)));
+    } else {
+      spin_pause(_spins);
+    }
+  }
+}
+
+/// \brief Calls \p p_call at \p p_rate calls per second, during
+/// \p p_duration, independently of how long each call takes
+///
+/// \details A timer thread publishes how many calls are due; the calling
+/// thread executes the calls as they are published, so a call
+/// that takes longer than the period delays the next ones, and the latency
+/// of a call, measured from its intended start, includes the time it waited,
+/// as a client with a fixed arrival rate would see it. Measuring from the
+/// actual start would omit that wait. The intended start of a call is
+/// computed from its index, so memory does not grow with the number of
+/// calls.
+///
+/// \param p_call called as 'p_call(std::size_t p_index)'
+template <typename t_call>
+load_point open_loop(double p_rate, std::chrono::nanoseconds p_duration,
+                     t_call &&p_call) {
+  const double _ticks_per_ns{tsc_ticks_per_ns()};
+  const std::size_t _count{std::max<std::size_t>(
+      1, static_cast<std::size_t>(p_rate * static_cast<double>(
+                                               p_duration.count()) /
+                                  1e9))};
+  const double _period_ticks{1e9 / p_rate * _ticks_per_ns};
+
+  std::atomic<std::size_t> _issued{0};
+  std::atomic<bool> _stop{false};
+
+  // gives the timer thread time to start before the first call is due
+  const std::uint64_t _start{
+      tsc() + static_cast<std::uint64_t>(1000000.0 * _ticks_per_ns)};
+
+  auto _due = [&](std::size_t p_index) {
+    return _start + static_cast<std::uint64_t>(static_cast<double>(p_index) *
+                                               _period_ticks);
+  };
+
+  std::thread _timer([&]() {
+    for (std::size_t _i = 0; (_i < _count) && !_stop.load(); ++_i) {
+      wait_until_tsc(_due(_i), _ticks_per_ns, _stop);
+      _issued.store(_i + 1, std::memory_order_release);
+    }
+  });
+
+  load_point _point;
+  _point.target = p_rate;
+  std::uint64_t _end{_start};
+  try {
+    std::size_t _spins{0};
+    for (std::size_t _i = 0; _i < _count; ++_i) {
+      while (_issued.load(std::memory_order_acquire) <= _i) {
+        spin_pause(_spins);
+      }
+      p_call(_i);
+      _end = tsc();
+      _point.latency.record(static_cast<std::uint64_t>(
+          static_cast<double>(_end - _due(_i)) / _ticks_per_ns));
+    }
+  } catch (...) {
+    _stop.store(true);
+    _timer.join();
+    throw;
+  }
+  _timer.join();
+
+  const double _seconds{static_cast<double>(_end - _start) / _ticks_per_ns /
+                        1e9};
+  _point.achieved = (_seconds > 0 ? static_cast<double>(_count) / _seconds
+                                  : p_rate);
+  return _point;
+}
+
+/// \brief A rate is saturated if less than this fraction of its calls per
+/// second completes
+static constexpr double load_min_achieved{0.95};
+
+/// \brief A rate is saturated if its 99th percentile latency is this many
+/// times the one of the lowest rate
+static constexpr double load_max_p99_growth{10.0};
+
+/// \brief Index of the highest rate before the first saturated one, which is
+/// where the latency starts growing faster than the throughput
+///
+/// \return empty if the first rate is already saturated, or the index of the
+/// last rate if none is
+inline std::optional<std::size_t> find_knee(
+    const std::vector<load_point> &p_points) {
+  if (p_points.empty()) {
+    return {};
+  }
+  const double _base_p99{
+      static_cast<double>(std::max<std::uint64_t>(
+          1, p_points.front().latency.percentile(0.99)))};
+  for (std::size_t _i = 0; _i < p_points.size(); ++_i) {
+    const load_point &_point{p_points[_i]};
+    const bool _saturated{
+        (_point.achieved < load_min_achieved * _point.target) ||
+        (static_cast<double>(_point.latency.percentile(0.99)) >
+         load_max_p99_growth * _base_p99)};
+    if (_saturated) {
+      if (_i == 0) {
+        return {};
+      }
+      return _i - 1;
+    }
+  }
+  return p_points.size() - 1;
+}
+
+/// \brief Prints the latencies of a benchmark at each rate as a table
+///
+/// \param p_service_ns mean nanoseconds of a call without load
+inline void print_load_text(std::ostream &p_out, std::string_view p_name,
+                            double p_service_ns,
+                            std::chrono::milliseconds p_duration,
+                            const std::vector<load_point> &p_points) {
+  using namespace std;
+  p_out << p_name << " LOAD (" << p_duration.count()
+        << " ms per rate, service mean " << fixed << setprecision(1)
+        << p_service_ns << defaultfloat << " ns)\n"
+        << "  " << setw(12) << "target/s" << setw(12) << "achieved/s"
+        << setw(12) << "p50 ns" << setw(12) << "p90 ns" << setw(12)
+        << "p99 ns" << setw(12) << "p99.9 ns" << setw(12) << "max ns"
+        << '\n';
+  for (const load_point &_point : p_points) {
+    p_out << "  " << fixed << setprecision(0) << setw(12) << _point.target
+          << setw(12) << _point.achieved << defaultfloat << setw(12)
+          << _point.latency.percentile(0.50) << setw(12)
+          << _point.latency.percentile(0.90) << setw(12)
+          << _point.latency.percentile(0.99) << setw(12)
+          << _point.latency.percentile(0.999) << setw(12)
+          << _point.latency.max() << '\n';
+  }
+
+  const optional<size_t> _knee{find_knee(p_points)};
+  p_out << "  knee: ";
+  if (!_knee) {
+    p_out << "below the lowest rate\n";
+  } else if (*_knee + 1 == p_points.size()) {
+    p_out << "not reached\n";
+  } else {
+    p_out << fixed << setprecision(0) << p_points[*_knee].target
+          << defaultfloat << " calls/s\n";
+  }
+  p_out << flush;
+}
+
+/// \brief Prints the latencies of a benchmark at one rate as a JSON object in
+/// one line
+inline void print_load_json(std::ostream &p_out, std::string_view p_name,
+                            const load_point &p_point) {
+  const std::streamsize _precision{p_out.precision(17)};
+  p_out << "{\"name\":";
+  print_json_string(p_out, p_name);
+  p_out << ",\"mode\":\"load\",\"target_per_s\":";
+  print_json_number(p_out, p_point.target);
+  p_out << ",\"achieved_per_s\":";
+  print_json_number(p_out, p_point.achieved);
+  p_out << ",\"calls\":" << p_point.latency.count() << ",\"mean_ns\":";
+  print_json_number(p_out, p_point.latency.mean());
+  p_out << ",\"p50_ns\":" << p_point.latency.percentile(0.50)
+        << ",\"p90_ns\":" << p_point.latency.percentile(0.90)
+        << ",\"p99_ns\":" << p_point.latency.percentile(0.99)
+        << ",\"p999_ns\":" << p_point.latency.percentile(0.999)
+        << ",\"max_ns\":" << p_point.latency.max() << '}' << std::endl;
+  p_out.precision(_precision);
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
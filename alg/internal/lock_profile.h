@@ -0,0 +1,240 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_LOCK_PROFILE_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_LOCK_PROFILE_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include <tenacitas.lib.test/alg/internal/tsc.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Maximum number of named locks profiled
+static constexpr std::size_t max_lock_sites{32};
+
+/// \brief Number of power of two buckets of the wait time histogram of a lock
+static constexpr std::size_t lock_wait_buckets{40};
+
+/// \brief Counters of a named lock, accumulated by one thread
+struct lock_counters {
+  std::uint64_t acquisitions{0};
+  std::uint64_t contended{0};
+  std::uint64_t wait_ticks{0};
+  std::uint64_t max_wait_ticks{0};
+  std::uint64_t hold_ticks{0};
+  std::uint64_t max_hold_ticks{0};
+  /// \brief Bucket \p i counts waits from 2^(i-1) to 2^i - 1 ticks
+  std::array<std::uint64_t, lock_wait_buckets> waits{};
+};
+
+/// \brief Counters of a named lock, accumulated by all the threads
+struct lock_site {
+  const char *name{nullptr};
+  std::atomic<std::uint64_t> acquisitions{0};
+  std::atomic<std::uint64_t> contended{0};
+  std::atomic<std::uint64_t> wait_ticks{0};
+  std::atomic<std::uint64_t> max_wait_ticks{0};
+  std::atomic<std::uint64_t> hold_ticks{0};
+  std::atomic<std::uint64_t> max_hold_ticks{0};
+  std::array<std::atomic<std::uint64_t>, lock_wait_buckets> waits{};
+
+  /// \brief Highest wait, in ticks, of the quantile \p p_quantile of the
+  /// acquisitions
+  std::uint64_t wait_percentile(double p_quantile) const {
+    const std::uint64_t _count{acquisitions.load(std::memory_order_relaxed)};
+    if (_count == 0) {
+      return 0;
+    }
+    const double _wanted{p_quantile * static_cast<double>(_count)};
+    std::uint64_t _seen{0};
+    for (std::size_t _i = 0; _i < lock_wait_buckets; ++_i) {
+      _seen += waits[_i].load(std::memory_order_relaxed);
+      if (static_cast<double>(_seen) >= _wanted) {
+        return std::min<std::uint64_t>(
+            (std::uint64_t{1} << _i) - 1,
+            max_wait_ticks.load(std::memory_order_relaxed));
+      }
+    }
+    return max_wait_ticks.load(std::memory_order_relaxed);
+  }
+};
+
+/// \brief Profile of the named locks, recorded by
+/// tenacitas::lib::test::alg::profiled_mutex and
+/// tenacitas::lib::test::alg::profiled_shared_mutex
+///
+/// \details Each thread accumulates its counters in a thread local table,
+/// without synchronization, and adds them to the shared sites when it
+/// finishes, or when \p flush is called. \p reset starts a new generation,
+/// and a thread discards counters of an older generation before recording.
+struct lock_profile {
+  /// \brief Identifier of the site of the lock named \p p_name, shared by all
+  /// the locks with the same name
+  ///
+  /// \param p_name must remain valid while the program runs, like a string
+  /// literal
+  ///
+  /// \throw std::length_error if there are more than \p max_lock_sites names
+  static std::size_t site(const char *p_name) {
+    std::lock_guard<std::mutex> _lock{m_sites_mutex};
+    for (std::size_t _i = 0; _i < m_num_sites; ++_i) {
+      if (std::strcmp(m_sites[_i].name, p_name) == 0) {
+        return _i;
+      }
+    }
+    if (m_num_sites == max_lock_sites) {
+      throw std::length_error("too many profiled locks, '" +
+                              std::string{p_name} + "' not registered");
+    }
+    m_sites[m_num_sites].name = p_name;
+    return m_num_sites++;
+  }
+
+  /// \brief Records an acquisition of a lock
+  ///
+  /// \param p_contended indicates the lock was not acquired immediately
+  ///
+  /// \param p_wait_ticks time waiting for the lock
+  static void on_acquire(std::size_t p_site, bool p_contended,
+                         std::uint64_t p_wait_ticks) {
+    lock_counters &_counters{local().counters(p_site)};
+    ++_counters.acquisitions;
+    if (p_contended) {
+      ++_counters.contended;
+    }
+    _counters.wait_ticks += p_wait_ticks;
+    _counters.max_wait_ticks = std::max(_counters.max_wait_ticks, p_wait_ticks);
+    ++_counters.waits[bucket(p_wait_ticks)];
+  }
+
+  /// \brief Records the time a lock was held
+  static void on_release(std::size_t p_site, std::uint64_t p_hold_ticks) {
+    lock_counters &_counters{local().counters(p_site)};
+    _counters.hold_ticks += p_hold_ticks;
+    _counters.max_hold_ticks = std::max(_counters.max_hold_ticks, p_hold_ticks);
+  }
+
+  /// \brief Discards the counters of all the sites
+  static void reset() {
+    m_generation.fetch_add(1, std::memory_order_acq_rel);
+    std::lock_guard<std::mutex> _lock{m_sites_mutex};
+    for (std::size_t _i = 0; _i < m_num_sites; ++_i) {
+      lock_site &_site{m_sites[_i]};
+      _site.acquisitions.store(0, std::memory_order_relaxed);
+      _site.contended.store(0, std::memory_order_relaxed);
+      _site.wait_ticks.store(0, std::memory_order_relaxed);
+      _site.max_wait_ticks.store(0, std::memory_order_relaxed);
+      _site.hold_ticks.store(0, std::memory_order_relaxed);
+      _site.max_hold_ticks.store(0, std::memory_order_relaxed);
+      for (std::atomic<std::uint64_t> &_wait : _site.waits) {
+        _wait.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// \brief Adds the counters of the calling thread to the sites
+  static void flush() { local().flush(); }
+
+  /// \brief Calls \p p_visitor for every site acquired since \p reset
+  ///
+  /// \details The counters of threads still running are not included, unless
+  /// they called \p flush
+  template <typename t_visitor> static void for_each(t_visitor &&p_visitor) {
+    std::lock_guard<std::mutex> _lock{m_sites_mutex};
+    for (std::size_t _i = 0; _i < m_num_sites; ++_i) {
+      if (m_sites[_i].acquisitions.load(std::memory_order_relaxed) != 0) {
+        p_visitor(static_cast<const lock_site &>(m_sites[_i]));
+      }
+    }
+  }
+
+private:
+  /// \brief Counters of the calling thread
+  struct thread_counters {
+    ~thread_counters() { flush(); }
+
+    lock_counters &counters(std::size_t p_site) {
+      const std::uint64_t _generation{
+          m_generation.load(std::memory_order_acquire)};
+      if (_generation != m_generation_seen) {
+        m_counters = {};
+        m_used = 0;
+        m_generation_seen = _generation;
+      }
+      m_used |= (std::uint64_t{1} << p_site);
+      return m_counters[p_site];
+    }
+
+    void flush() {
+      if (m_generation_seen != m_generation.load(std::memory_order_acquire)) {
+        m_used = 0;
+      }
+      for (std::size_t _i = 0; m_used != 0; ++_i, m_used >>= 1) {
+        if ((m_used & 1) == 0) {
+          continue;
+        }
+        lock_counters &_from{m_counters[_i]};
+        lock_site &_to{m_sites[_i]};
+        _to.acquisitions.fetch_add(_from.acquisitions,
+                                   std::memory_order_relaxed);
+        _to.contended.fetch_add(_from.contended, std::memory_order_relaxed);
+        _to.wait_ticks.fetch_add(_from.wait_ticks, std::memory_order_relaxed);
+        _to.hold_ticks.fetch_add(_from.hold_ticks, std::memory_order_relaxed);
+        store_max(_to.max_wait_ticks, _from.max_wait_ticks);
+        store_max(_to.max_hold_ticks, _from.max_hold_ticks);
+        for (std::size_t _b = 0; _b < lock_wait_buckets; ++_b) {
+          _to.waits[_b].fetch_add(_from.waits[_b], std::memory_order_relaxed);
+        }
+        _from = {};
+      }
+    }
+
+    std::array<lock_counters, max_lock_sites> m_counters{};
+    std::uint64_t m_used{0};
+    std::uint64_t m_generation_seen{0};
+  };
+
+  static_assert(max_lock_sites <= 64, "'m_used' has one bit per site");
+
+  static thread_counters &local() {
+    static thread_local thread_counters _counters;
+    return _counters;
+  }
+
+  static std::size_t bucket(std::uint64_t p_ticks) {
+    const std::size_t _bits{
+        p_ticks == 0 ? 0
+                     : static_cast<std::size_t>(64 - __builtin_clzll(p_ticks))};
+    return std::min(_bits, lock_wait_buckets - 1);
+  }
+
+  static void store_max(std::atomic<std::uint64_t> &p_max,
+                        std::uint64_t p_value) {
+    std::uint64_t _cur{p_max.load(std::memory_order_relaxed)};
+    while ((_cur < p_value) &&
+           !p_max.compare_exchange_weak(_cur, p_value,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+private:
+  static inline std::mutex m_sites_mutex;
+  static inline std::array<lock_site, max_lock_sites> m_sites;
+  static inline std::size_t m_num_sites{0};
+  static inline std::atomic<std::uint64_t> m_generation{0};
+};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_MODE_HOOKS_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_MODE_HOOKS_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace tenacitas::lib::program::alg {
+struct options;
+} // namespace tenacitas::lib::program::alg
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Options of tenacitas::lib::test::alg::tester that execute no test,
+/// but replace the execution of the program
+///
+/// \details The functions are installed by
+/// tenacitas.lib.test/alg/tester_modes.h, so the programs that do not include
+/// it do not compile them. If they are not installed, they are \p nullptr
+struct mode_hooks {
+  /// \brief Compares the benchmarks of the programs passed with '--ab'
+  ///
+  /// \param p_bench_iterations, p_cold_cache and p_cold_cache_bytes are
+  /// passed to the programs compared
+  static inline void (*ab)(const program::alg::options &p_options,
+                           std::size_t p_bench_iterations, bool p_cold_cache,
+                           std::size_t p_cold_cache_bytes){nullptr};
+
+  /// \brief Prints the results in the file passed with '--result-log-print'
+  static inline void (*result_log_print)(std::ostream &p_out,
+                                         const std::string &p_path){nullptr};
+};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_PERF_COUNTERS_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_PERF_COUNTERS_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Event that can be counted by \p perf_counters
+struct perf_event {
+  const char *name;
+  std::uint32_t type;
+  std::uint64_t config;
+};
+
+/// \brief Events related to the translation of virtual addresses, used to
+/// compare the behaviour of 4K and huge pages
+inline const std::vector<perf_event> &tlb_events() {
+  static const std::vector<perf_event> _events{
+      {"dTLB-load-misses", PERF_TYPE_HW_CACHE,
+       PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+      {"dTLB-store-misses", PERF_TYPE_HW_CACHE,
+       PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_WRITE << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+      {"iTLB-load-misses", PERF_TYPE_HW_CACHE,
+       PERF_COUNT_HW_CACHE_ITLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+      {"page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}};
+  return _events;
+}
+
+/// \brief Counts hardware and software events of the calling thread, using
+/// 'perf_event_open'
+///
+/// \details Events that can not be opened, because of the hardware or of
+/// '/proc/sys/kernel/perf_event_paranoid', are silently ignored, and
+/// reported as not available. Only user space is counted.
+struct perf_counters {
+  explicit perf_counters(const std::vector<perf_event> &p_events) {
+    for (const perf_event &_event : p_events) {
+      perf_event_attr _attr;
+      std::memset(&_attr, 0, sizeof(_attr));
+      _attr.size = sizeof(_attr);
+      _attr.type = _event.type;
+      _attr.config = _event.config;
+      _attr.disabled = 1;
+      _attr.exclude_kernel = 1;
+      _attr.exclude_hv = 1;
+
+      const int _fd{static_cast<int>(
+          syscall(SYS_perf_event_open, &_attr, 0, -1, -1, 0))};
+      m_counters.push_back({_event.name, _fd});
+    }
+  }
+
+  perf_counters(const perf_counters &) = delete;
+  perf_counters &operator=(const perf_counters &) = delete;
+
+  ~perf_counters() {
+    for (const counter &_counter : m_counters) {
+      if (_counter.fd >= 0) {
+        close(_counter.fd);
+      }
+    }
+  }
+
+  /// \brief Starts counting
+  void enable() {
+    for (const counter &_counter : m_counters) {
+      if (_counter.fd >= 0) {
+        ioctl(_counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  /// \brief Stops counting
+  void disable() {
+    for (const counter &_counter : m_counters) {
+      if (_counter.fd >= 0) {
+        ioctl(_counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+  }
+
+  /// \brief Sets all the counts to zero
+  void reset() {
+    for (const counter &_counter : m_counters) {
+      if (_counter.fd >= 0) {
+        ioctl(_counter.fd, PERF_EVENT_IOC_RESET, 0);
+      }
+    }
+  }
+
+  /// \brief Calls \p p_visitor with the name of each event, if it is
+  /// available, and its count
+  template <typename t_visitor> void for_each(t_visitor &&p_visitor) const {
+    for (const counter &_counter : m_counters) {
+      std::uint64_t _value{0};
+      const bool _available{
+          (_counter.fd >= 0) &&
+          (read(_counter.fd, &_value, sizeof(_value)) ==
+           static_cast<ssize_t>(sizeof(_value)))};
+      p_visitor(_counter.name, _available, _value);
+    }
+  }
+
+private:
+  struct counter {
+    const char *name;
+    int fd;
+  };
+
+  std::vector<counter> m_counters;
+};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,375 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_RESULT_LOG_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_RESULT_LOG_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <link.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <tenacitas.lib.test/alg/internal/stack_trace.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Status of a test, or benchmark, in a \p result_log
+enum class result_status : std::uint8_t {
+  running,
+  success,
+  fail,
+  error,
+  crashed
+};
+
+/// \brief Result of a test, or benchmark, with a fixed size, as stored in a
+/// \p result_log
+struct result_record {
+  static constexpr std::size_t max_name{128};
+
+  char name[max_name];
+  result_status status;
+  std::int32_t signal;
+  /// \brief Nanoseconds since the epoch
+  std::uint64_t start_ns;
+  std::uint64_t end_ns;
+  std::uint8_t stack_size;
+  std::uintptr_t stack[max_stack_frames];
+};
+
+/// \brief First bytes of a \p result_log file
+struct result_log_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t capacity;
+  std::uint64_t count;
+  std::int32_t pid;
+  /// \brief Addresses of the program when the log was written, used to
+  /// resolve the crash stacks in another execution
+  std::uintptr_t program_low;
+  std::uintptr_t program_high;
+};
+
+/// \brief File of fixed size result records, mapped in memory and shared
+/// with the kernel, so the results recorded survive the process being killed
+/// by a signal, without any flush
+///
+/// \details Each test, or benchmark, has its record written with status
+/// \p result_status::running before it starts, and updated when it
+/// finishes. If the process receives SIGSEGV, SIGBUS, SIGFPE, SIGILL or
+/// SIGABRT, a handler, running in an alternate stack, marks the running
+/// record as \p result_status::crashed, with the signal and the call stack
+/// captured from the frame pointers of the interrupted code, and the signal
+/// is raised again with its default action.
+struct result_log {
+  static constexpr char magic[8]{'T', 'N', 'C', 'T', 'S', 'L', 'O', 'G'};
+  static constexpr std::uint32_t version{1};
+
+  result_log() = default;
+  result_log(const result_log &) = delete;
+  result_log &operator=(const result_log &) = delete;
+
+  ~result_log() { close(); }
+
+  /// \brief Creates the file, and installs the signal handlers
+  ///
+  /// \param p_capacity maximum number of records
+  ///
+  /// \throw std::runtime_error if the file can not be created or mapped
+  void create(const std::string &p_path, std::size_t p_capacity) {
+    close();
+    const int _fd{::open(p_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+    if (_fd < 0) {
+      throw std::runtime_error("could not create '" + p_path +
+                               "': " + std::strerror(errno));
+    }
+    m_size = sizeof(result_log_header) + p_capacity * sizeof(result_record);
+    if (ftruncate(_fd, static_cast<off_t>(m_size)) != 0) {
+      ::close(_fd);
+      throw std::runtime_error("could not size '" + p_path +
+                               "': " + std::strerror(errno));
+    }
+    void *_addr{
+        mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0)};
+    ::close(_fd);
+    if (_addr == MAP_FAILED) {
+      throw std::runtime_error("could not map '" + p_path +
+                               "': " + std::strerror(errno));
+    }
+    m_header = static_cast<result_log_header *>(_addr);
+    std::memcpy(m_header->magic, magic, sizeof(magic));
+    m_header->version = version;
+    m_header->record_size = sizeof(result_record);
+    m_header->capacity = p_capacity;
+    m_header->count = 0;
+    m_header->pid = static_cast<std::int32_t>(getpid());
+    program_range(m_header->program_low, m_header->program_high);
+
+    install_handlers();
+  }
+
+  /// \brief Informs if the results are being logged
+  bool active() const { return m_header != nullptr; }
+
+  /// \brief Records that a test, or benchmark, started
+  void begin(std::string_view p_name) {
+    if ((m_header == nullptr) || (m_header->count == m_header->capacity)) {
+      return;
+    }
+    // caches the stack limits of this thread, so the signal handler does not
+    // need to query them
+    std::uintptr_t _low{0};
+    std::uintptr_t _high{0};
+    stack_limits(_low, _high);
+
+    result_record &_record{records()[m_header->count]};
+    std::memset(&_record, 0, sizeof(_record));
+    std::memcpy(_record.name, p_name.data(),
+                std::min(p_name.size(), result_record::max_name - 1));
+    _record.status = result_status::running;
+    _record.start_ns = now_ns();
+    ++m_header->count;
+    m_current = &_record;
+  }
+
+  /// \brief Records how the test, or benchmark, started by \p begin finished
+  void end(result_status p_status) {
+    if (m_current == nullptr) {
+      return;
+    }
+    m_current->end_ns = now_ns();
+    m_current->status = p_status;
+    m_current = nullptr;
+  }
+
+  /// \brief Prints the records of a log file, possibly written by a process
+  /// that crashed
+  ///
+  /// \throw std::runtime_error if the file can not be read, or if it is not a
+  /// result log
+  static void print(std::ostream &p_out, const std::string &p_path) {
+    using namespace std;
+    const int _fd{::open(p_path.c_str(), O_RDONLY)};
+    if (_fd < 0) {
+      throw runtime_error("could not open '" + p_path +
+                          "': " + strerror(errno));
+    }
+    struct stat _stat {};
+    fstat(_fd, &_stat);
+    const size_t _size{static_cast<size_t>(_stat.st_size)};
+    void *_addr{_size >= sizeof(result_log_header)
+                    ? mmap(nullptr, _size, PROT_READ, MAP_SHARED, _fd, 0)
+                    : MAP_FAILED};
+    ::close(_fd);
+    if (_addr == MAP_FAILED) {
+      throw runtime_error("could not map '" + p_path + "'");
+    }
+
+    const auto *_header{static_cast<const result_log_header *>(_addr)};
+    if ((memcmp(_header->magic, magic, sizeof(magic)) != 0) ||
+        (_header->version != version) ||
+        (_header->record_size != sizeof(result_record)) ||
+        (sizeof(result_log_header) + _header->count * sizeof(result_record) >
+         _size)) {
+      munmap(_addr, _size);
+      throw runtime_error("'" + p_path + "' is not a valid result log");
+    }
+
+    uintptr_t _low{0};
+    uintptr_t _high{0};
+    program_range(_low, _high);
+
+    p_out << "result log '" << p_path << "' of process " << _header->pid
+          << ", " << _header->count << " record(s)\n";
+    const auto *_records{reinterpret_cast<const result_record *>(_header + 1)};
+    for (uint64_t _i = 0; _i < _header->count; ++_i) {
+      const result_record &_record{_records[_i]};
+      p_out << "  " << string(_record.name, strnlen(_record.name,
+                                                    result_record::max_name))
+            << ' ';
+      switch (_record.status) {
+      case result_status::running:
+        p_out << "INTERRUPTED\n";
+        break;
+      case result_status::success:
+        p_out << "SUCCESS";
+        break;
+      case result_status::fail:
+        p_out << "FAIL";
+        break;
+      case result_status::error:
+        p_out << "ERROR";
+        break;
+      case result_status::crashed:
+        p_out << "CRASHED by signal " << _record.signal << " ("
+              << strsignal(_record.signal) << ")\n";
+        break;
+      }
+      if ((_record.status != result_status::running) &&
+          (_record.status != result_status::crashed)) {
+        p_out << " (" << fixed << setprecision(3)
+              << static_cast<double>(_record.end_ns - _record.start_ns) / 1e6
+              << defaultfloat << " ms)\n";
+      }
+
+      stack_trace _stack;
+      _stack.size = min<uint8_t>(_record.stack_size, max_stack_frames);
+      for (uint8_t _f = 0; _f < _stack.size; ++_f) {
+        uintptr_t _addr_f{_record.stack[_f]};
+        if ((_addr_f >= _header->program_low) &&
+            (_addr_f < _header->program_high)) {
+          _addr_f = _addr_f - _header->program_low + _low;
+        }
+        _stack.frames[_f] = reinterpret_cast<void *>(_addr_f);
+      }
+      print_stack(p_out, _stack, "    ");
+    }
+    p_out << flush;
+    munmap(_addr, _size);
+  }
+
+private:
+  result_record *records() {
+    return reinterpret_cast<result_record *>(m_header + 1);
+  }
+
+  static std::uint64_t now_ns() {
+    timespec _ts{};
+    clock_gettime(CLOCK_REALTIME, &_ts);
+    return static_cast<std::uint64_t>(_ts.tv_sec) * 1000000000 +
+           static_cast<std::uint64_t>(_ts.tv_nsec);
+  }
+
+  /// \brief Range of addresses of the loaded segments of the program
+  static void program_range(std::uintptr_t &p_low, std::uintptr_t &p_high) {
+    std::uintptr_t _range[2]{0, 0};
+    dl_iterate_phdr(
+        [](dl_phdr_info *p_info, std::size_t, void *p_data) -> int {
+          auto *_range{static_cast<std::uintptr_t *>(p_data)};
+          for (ElfW(Half) _i = 0; _i < p_info->dlpi_phnum; ++_i) {
+            const ElfW(Phdr) &_phdr{p_info->dlpi_phdr[_i]};
+            if (_phdr.p_type != PT_LOAD) {
+              continue;
+            }
+            const std::uintptr_t _begin{p_info->dlpi_addr + _phdr.p_vaddr};
+            const std::uintptr_t _end{_begin + _phdr.p_memsz};
+            if ((_range[0] == 0) || (_begin < _range[0])) {
+              _range[0] = _begin;
+            }
+            _range[1] = std::max(_range[1], _end);
+          }
+          // the first object is the program
+          return 1;
+        },
+        _range);
+    p_low = _range[0];
+    p_high = _range[1];
+  }
+
+  void install_handlers() {
+    m_active = this;
+    if (m_alt_stack == nullptr) {
+      void *_stack{mmap(nullptr, m_alt_stack_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+      if (_stack != MAP_FAILED) {
+        m_alt_stack = _stack;
+        stack_t _ss{};
+        _ss.ss_sp = m_alt_stack;
+        _ss.ss_size = m_alt_stack_size;
+        sigaltstack(&_ss, nullptr);
+      }
+    }
+
+    struct sigaction _action {};
+    _action.sa_sigaction = &on_signal;
+    _action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND;
+    sigemptyset(&_action.sa_mask);
+    for (int _signal : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+      sigaction(_signal, &_action, nullptr);
+    }
+  }
+
+  void close() {
+    if (m_header != nullptr) {
+      if (m_active == this) {
+        m_active = nullptr;
+      }
+      munmap(m_header, m_size);
+      m_header = nullptr;
+      m_current = nullptr;
+    }
+  }
+
+  /// \brief Records the crash in the running record, and lets the default
+  /// action of the signal finish the process
+  ///
+  /// \details Only async signal safe operations are done
+  static void on_signal(int p_signal, siginfo_t *, void *p_context) {
+    result_log *_log{m_active};
+    if ((_log != nullptr) && (_log->m_current != nullptr)) {
+      result_record &_record{*_log->m_current};
+      _record.signal = p_signal;
+      _record.end_ns = now_ns();
+
+      const auto *_context{static_cast<const ucontext_t *>(p_context)};
+      std::uintptr_t _pc{0};
+      std::uintptr_t _fp{0};
+#if defined(__x86_64__)
+      _pc = static_cast<std::uintptr_t>(_context->uc_mcontext.gregs[REG_RIP]);
+      _fp = static_cast<std::uintptr_t>(_context->uc_mcontext.gregs[REG_RBP]);
+#elif defined(__aarch64__)
+      _pc = static_cast<std::uintptr_t>(_context->uc_mcontext.pc);
+      _fp = static_cast<std::uintptr_t>(_context->uc_mcontext.regs[29]);
+#else
+      (void)_context;
+#endif
+      std::uint8_t _size{0};
+      if (_pc != 0) {
+        _record.stack[_size++] = _pc;
+      }
+      stack_trace _callers;
+      capture_stack(_callers, reinterpret_cast<const void *>(_fp));
+      for (std::uint8_t _i = 0;
+           (_i < _callers.size) && (_size < max_stack_frames); ++_i) {
+        _record.stack[_size++] =
+            reinterpret_cast<std::uintptr_t>(_callers.frames[_i]);
+      }
+      _record.stack_size = _size;
+      _record.status = result_status::crashed;
+    }
+    raise(p_signal);
+  }
+
+private:
+  static constexpr std::size_t m_alt_stack_size{64 * 1024};
+
+  static inline result_log *m_active{nullptr};
+  static inline void *m_alt_stack{nullptr};
+
+  result_log_header *m_header{nullptr};
+  std::size_t m_size{0};
+  result_record *m_current{nullptr};
+};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_SCHED_STATS_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_SCHED_STATS_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Maximum number of threads whose scheduling is reported per test
+static constexpr std::size_t max_sched_threads{256};
+
+/// \brief Time a thread spent on a CPU and waiting in a run queue, from
+/// '/proc/self/task/<tid>/schedstat'
+struct thread_sched {
+  pid_t tid{0};
+  std::uint64_t cpu_ns{0};
+  std::uint64_t wait_ns{0};
+};
+
+/// \brief Scheduling of the process at a moment
+///
+/// \details It does not allocate memory, so it can be taken while allocations
+/// are being checked
+struct sched_snapshot {
+  /// \brief Reads the clocks and the 'schedstat' of every thread
+  void take() {
+    m_wall = std::chrono::steady_clock::now();
+
+    timespec _ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &_ts);
+    m_process_cpu_ns = static_cast<std::uint64_t>(_ts.tv_sec) * 1000000000 +
+                       static_cast<std::uint64_t>(_ts.tv_nsec);
+
+    m_num_threads = 0;
+    m_available = false;
+    DIR *_dir{opendir("/proc/self/task")};
+    if (_dir == nullptr) {
+      return;
+    }
+    while (dirent *_entry = readdir(_dir)) {
+      if ((_entry->d_name[0] < '0') || (_entry->d_name[0] > '9') ||
+          (m_num_threads == max_sched_threads)) {
+        continue;
+      }
+      thread_sched _thread;
+      _thread.tid = static_cast<pid_t>(std::atol(_entry->d_name));
+      if (read(_thread)) {
+        m_threads[m_num_threads++] = _thread;
+        m_available = true;
+      }
+    }
+    closedir(_dir);
+  }
+
+  /// \brief Informs if 'schedstat' could be read
+  bool available() const { return m_available; }
+
+  std::chrono::steady_clock::time_point wall() const { return m_wall; }
+
+  std::uint64_t process_cpu_ns() const { return m_process_cpu_ns; }
+
+  /// \return the thread \p p_tid, or one with zero times if it did not exist
+  thread_sched thread(pid_t p_tid) const {
+    for (std::size_t _i = 0; _i < m_num_threads; ++_i) {
+      if (m_threads[_i].tid == p_tid) {
+        return m_threads[_i];
+      }
+    }
+    return {p_tid, 0, 0};
+  }
+
+  template <typename t_visitor> void for_each(t_visitor &&p_visitor) const {
+    for (std::size_t _i = 0; _i < m_num_threads; ++_i) {
+      p_visitor(m_threads[_i]);
+    }
+  }
+
+private:
+  static bool read(thread_sched &p_thread) {
+    char _path[64];
+    std::snprintf(_path, sizeof(_path), "/proc/self/task/%d/schedstat",
+                  static_cast<int>(p_thread.tid));
+    const int _fd{open(_path, O_RDONLY)};
+    if (_fd < 0) {
+      return false;
+    }
+    char _buf[128];
+    const ssize_t _read{::read(_fd, _buf, sizeof(_buf) - 1)};
+    close(_fd);
+    if (_read <= 0) {
+      return false;
+    }
+    _buf[_read] = '\0';
+    char *_end{nullptr};
+    p_thread.cpu_ns = std::strtoull(_buf, &_end, 10);
+    p_thread.wait_ns = std::strtoull(_end, nullptr, 10);
+    return true;
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_wall;
+  std::uint64_t m_process_cpu_ns{0};
+  std::array<thread_sched, max_sched_threads> m_threads;
+  std::size_t m_num_threads{0};
+  bool m_available{false};
+};
+
+/// \brief Identifier of the calling thread, as in '/proc/self/task'
+inline pid_t current_tid() { return static_cast<pid_t>(syscall(SYS_gettid)); }
+
+/// \brief Prints how the wall time of a test was spent: on a CPU, waiting in
+/// a run queue, or blocked, for the thread that executed it, and the CPU
+/// time of the other threads
+///
+/// \param p_tid thread that executed the test
+inline void print_sched(std::ostream &p_out, std::string_view p_name,
+                        const sched_snapshot &p_before,
+                        const sched_snapshot &p_after, pid_t p_tid) {
+  using namespace std;
+  auto _ms = [](double p_ns) { return p_ns / 1e6; };
+
+  const double _wall_ns{static_cast<double>(
+      chrono::duration_cast<chrono::nanoseconds>(p_after.wall() -
+                                                 p_before.wall())
+          .count())};
+  const double _process_cpu_ns{
+      static_cast<double>(p_after.process_cpu_ns() - p_before.process_cpu_ns())};
+
+  p_out << "TIME for " << p_name << ':' << fixed << setprecision(3)
+        << " wall " << _ms(_wall_ns) << " ms";
+
+  if (!p_after.available()) {
+    p_out << ", cpu " << _ms(_process_cpu_ns)
+          << " ms (all threads), run queue not available\n"
+          << defaultfloat << flush;
+    return;
+  }
+
+  const thread_sched _main_before{p_before.thread(p_tid)};
+  const thread_sched _main_after{p_after.thread(p_tid)};
+  const double _main_cpu{
+      static_cast<double>(_main_after.cpu_ns - _main_before.cpu_ns)};
+  const double _main_wait{
+      static_cast<double>(_main_after.wait_ns - _main_before.wait_ns)};
+  const double _blocked{max(0.0, _wall_ns - _main_cpu - _main_wait)};
+
+  p_out << ", cpu " << _ms(_main_cpu) << " ms, run queue " << _ms(_main_wait)
+        << " ms, blocked " << _ms(_blocked) << " ms\n";
+
+  double _threads_cpu{_main_cpu};
+  p_after.for_each([&](const thread_sched &p_thread) {
+    if (p_thread.tid == p_tid) {
+      return;
+    }
+    const thread_sched _before{p_before.thread(p_thread.tid)};
+    const double _cpu{static_cast<double>(p_thread.cpu_ns - _before.cpu_ns)};
+    const double _wait{static_cast<double>(p_thread.wait_ns - _before.wait_ns)};
+    if ((_cpu == 0) && (_wait == 0)) {
+      return;
+    }
+    _threads_cpu += _cpu;
+    p_out << "  thread " << p_thread.tid << ": cpu " << _ms(_cpu)
+          << " ms, run queue " << _ms(_wait) << " ms\n";
+  });
+
+  // threads that ended during the test are not in '/proc/self/task' anymore,
+  // but their cpu time is in the process cpu time
+  const double _ended_cpu{_process_cpu_ns - _threads_cpu};
+  if (_ended_cpu > 0.01 * _process_cpu_ns && _ended_cpu > 100000) {
+    p_out << "  ended threads: cpu " << _ms(_ended_cpu) << " ms\n";
+  }
+  p_out << defaultfloat << flush;
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
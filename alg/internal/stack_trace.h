@@ -0,0 +1,135 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_STACK_TRACE_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_STACK_TRACE_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Maximum number of frames kept in a \p stack_trace
+static constexpr std::size_t max_stack_frames{16};
+
+/// \brief Fixed size call stack, that can be captured without allocating
+/// memory
+struct stack_trace {
+  void *frames[max_stack_frames] = {nullptr};
+  std::uint8_t size = {0};
+};
+
+/// \brief Limits of the stack of the calling thread, cached per thread
+///
+/// \details \p pthread_getattr_np may allocate memory, so the caller must make
+/// sure that a allocation hook will not call it recursively
+inline bool stack_limits(std::uintptr_t &p_low, std::uintptr_t &p_high) {
+  static thread_local std::uintptr_t _low{0};
+  static thread_local std::uintptr_t _high{0};
+  static thread_local bool _tried{false};
+
+  if (!_tried) {
+    _tried = true;
+    pthread_attr_t _attr;
+    if (pthread_getattr_np(pthread_self(), &_attr) == 0) {
+      void *_addr{nullptr};
+      std::size_t _size{0};
+      if (pthread_attr_getstack(&_attr, &_addr, &_size) == 0) {
+        _low = reinterpret_cast<std::uintptr_t>(_addr);
+        _high = _low + _size;
+      }
+      pthread_attr_destroy(&_attr);
+    }
+  }
+  p_low = _low;
+  p_high = _high;
+  return _high != 0;
+}
+
+/// \brief Captures the call stack by following the frame pointers
+///
+/// \details Every frame pointer is checked against the limits of the thread
+/// stack before being read, so code compiled with '-fomit-frame-pointer' only
+/// produces shorter traces, and never an invalid read. No memory is
+/// allocated.
+///
+/// \param p_trace where the return addresses will be stored
+///
+/// \param p_frame frame where the unwinding starts, usually the result of
+/// '__builtin_frame_address(0)' in the function whose caller is the first frame
+/// of interest
+inline void capture_stack(stack_trace &p_trace, const void *p_frame) {
+  p_trace.size = 0;
+
+  std::uintptr_t _low{0};
+  std::uintptr_t _high{0};
+  if (!stack_limits(_low, _high)) {
+    return;
+  }
+
+  auto _fp = reinterpret_cast<std::uintptr_t>(p_frame);
+
+  while ((p_trace.size < max_stack_frames) && (_fp >= _low) &&
+         (_fp + 2 * sizeof(std::uintptr_t) <= _high) &&
+         ((_fp % sizeof(std::uintptr_t)) == 0)) {
+    const auto *_frame = reinterpret_cast<const std::uintptr_t *>(_fp);
+    const std::uintptr_t _next{_frame[0]};
+    const std::uintptr_t _ret{_frame[1]};
+    if (_ret == 0) {
+      break;
+    }
+    p_trace.frames[p_trace.size++] = reinterpret_cast<void *>(_ret);
+    if (_next <= _fp) {
+      break;
+    }
+    _fp = _next;
+  }
+}
+
+/// \brief Prints the symbol of a return address
+///
+/// \details If the symbol is not exported (link with '-rdynamic' to export
+/// them), the module and offset are printed, so 'addr2line' can be used
+inline void print_frame(std::ostream &p_out, void *p_addr) {
+  Dl_info _info;
+  if ((dladdr(p_addr, &_info) == 0) || (_info.dli_fname == nullptr)) {
+    p_out << p_addr;
+    return;
+  }
+
+  if (_info.dli_sname != nullptr) {
+    int _status{-1};
+    char *_demangled{
+        abi::__cxa_demangle(_info.dli_sname, nullptr, nullptr, &_status)};
+    p_out << (_status == 0 ? _demangled : _info.dli_sname);
+    std::free(_demangled);
+  } else {
+    p_out << _info.dli_fname << "(+0x" << std::hex
+          << (reinterpret_cast<std::uintptr_t>(p_addr) -
+              reinterpret_cast<std::uintptr_t>(_info.dli_fbase))
+          << std::dec << ')';
+  }
+}
+
+/// \brief Prints one frame per line, indented by \p p_indent
+inline void print_stack(std::ostream &p_out, const stack_trace &p_trace,
+                        const char *p_indent = "\t") {
+  for (std::uint8_t _i = 0; _i < p_trace.size; ++_i) {
+    p_out << p_indent << '#' << static_cast<int>(_i) << ' ';
+    print_frame(p_out, p_trace.frames[_i]);
+    p_out << '\n';
+  }
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
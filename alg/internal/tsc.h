@@ -0,0 +1,61 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_TSC_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_TSC_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <chrono>
+#include <cstdint>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Reads the time stamp counter
+///
+/// \details On x86 the 'lfence' keeps the read from being executed before the
+/// instructions that precede it; on other architectures, nanoseconds of
+/// 'std::chrono::steady_clock' are returned. The builtins are used instead
+/// of '<x86intrin.h>', which takes most of a second to compile in every
+/// translation unit that includes the tester
+inline std::uint64_t tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_lfence();
+  const std::uint64_t _ticks{__builtin_ia32_rdtsc()};
+  __builtin_ia32_lfence();
+  return _ticks;
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+/// \brief Number of \p tsc ticks in one nanosecond, measured once against
+/// 'std::chrono::steady_clock' during 10 milliseconds
+inline double tsc_ticks_per_ns() {
+#if defined(__x86_64__) || defined(__i386__)
+  static const double _ticks_per_ns{[]() {
+    using clock = std::chrono::steady_clock;
+    const clock::time_point _start{clock::now()};
+    const std::uint64_t _tsc_start{tsc()};
+    clock::time_point _now{_start};
+    while (_now - _start < std::chrono::milliseconds(10)) {
+      _now = clock::now();
+    }
+    const std::uint64_t _tsc_end{tsc()};
+    const double _ns{static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(_now - _start)
+            .count())};
+    return static_cast<double>(_tsc_end - _tsc_start) / _ns;
+  }()};
+  return _ticks_per_ns;
+#else
+  return 1.0;
+#endif
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
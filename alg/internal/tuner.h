@@ -0,0 +1,341 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_TUNER_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_TUNER_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <tenacitas.lib.program/alg/options.h>
+#include <tenacitas.lib.test/alg/internal/bench_stats.h>
+#include <tenacitas.lib.test/alg/tune.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief How the configurations of a \p tune_space are explored
+enum class tune_strategy : std::uint8_t {
+  /// \brief All the configurations are measured
+  grid,
+  /// \brief A random sample of the configurations is measured
+  random,
+  /// \brief All the configurations are measured, and the best half is
+  /// measured again, with twice the iterations, until one is left
+  halving
+};
+
+inline std::ostream &operator<<(std::ostream &p_out, tune_strategy p_strategy) {
+  switch (p_strategy) {
+  case tune_strategy::grid:
+    p_out << "grid";
+    break;
+  case tune_strategy::random:
+    p_out << "random";
+    break;
+  case tune_strategy::halving:
+    p_out << "halving";
+    break;
+  }
+  return p_out;
+}
+
+/// \throw std::invalid_argument if \p p_text is not "grid", "random" or
+/// "halving"
+inline tune_strategy parse_tune_strategy(const std::string &p_text) {
+  if (p_text == "grid") {
+    return tune_strategy::grid;
+  }
+  if (p_text == "random") {
+    return tune_strategy::random;
+  }
+  if (p_text == "halving") {
+    return tune_strategy::halving;
+  }
+  throw std::invalid_argument("unknown tune strategy '" + p_text + "'");
+}
+
+/// \brief Options of the benchmarks executed with 'run_tune'
+struct tune_settings {
+  /// \brief Reads the options described in the constructor of
+  /// tenacitas::lib::test::alg::tester
+  ///
+  /// \throw std::invalid_argument if an option is not valid
+  static tune_settings parse(const program::alg::options &p_options) {
+    tune_settings _settings;
+    _settings.enabled = p_options.get_bool_param("tune");
+    if (!_settings.enabled) {
+      return _settings;
+    }
+    std::optional<program::alg::options::value> _maybe_strategy =
+        p_options.get_single_param("tune-strategy");
+    if (_maybe_strategy) {
+      _settings.strategy = parse_tune_strategy(*_maybe_strategy);
+    }
+    std::optional<program::alg::options::value> _maybe_samples =
+        p_options.get_single_param("tune-samples");
+    if (_maybe_samples) {
+      _settings.samples = std::stoul(*_maybe_samples);
+      if (_settings.samples == 0) {
+        throw std::invalid_argument("'--tune-samples' must be at least 1");
+      }
+    }
+    std::optional<program::alg::options::value> _maybe_repeats =
+        p_options.get_single_param("tune-repeats");
+    if (_maybe_repeats) {
+      _settings.repeats = std::stoul(*_maybe_repeats);
+      if (_settings.repeats == 0) {
+        throw std::invalid_argument("'--tune-repeats' must be at least 1");
+      }
+    }
+    std::optional<program::alg::options::value> _maybe_iterations =
+        p_options.get_single_param("tune-iterations");
+    if (_maybe_iterations) {
+      _settings.iterations = std::stoul(*_maybe_iterations);
+    }
+    std::optional<program::alg::options::value> _maybe_output =
+        p_options.get_single_param("tune-output");
+    if (_maybe_output) {
+      _settings.output = *_maybe_output;
+    }
+    return _settings;
+  }
+
+  /// \brief The parameters are tuned; otherwise, the benchmarks are executed
+  /// with the first value of each parameter
+  bool enabled{false};
+
+  /// \brief How the configurations of the parameters are explored
+  tune_strategy strategy{tune_strategy::grid};
+
+  /// \brief Number of configurations measured by the random strategy
+  std::size_t samples{16};
+
+  /// \brief Number of times each configuration is measured in a round
+  std::size_t repeats{5};
+
+  /// \brief Number of iterations of each measurement of a configuration, in
+  /// the first round
+  std::size_t iterations{100};
+
+  /// \brief Directory where the tuned headers are written; if empty, they are
+  /// printed
+  std::string output;
+};
+
+/// \brief Maximum number of configurations measured by \p tune_strategy::grid
+/// and \p tune_strategy::halving
+static constexpr std::size_t max_tune_grid{1000000};
+
+/// \brief Measurements of a configuration
+struct tune_trial {
+  tune_config config;
+  /// \brief Median nanoseconds per iteration of each repetition, in the last
+  /// round the configuration was measured
+  std::vector<double> medians;
+  /// \brief Median of \p medians
+  double score{0};
+  /// \brief Number of rounds the configuration was measured
+  std::size_t rounds{0};
+};
+
+/// \brief Number of configurations of \p p_space, saturated at the maximum
+/// \p std::size_t
+inline std::size_t tune_grid_size(const tune_space &p_space) {
+  std::size_t _size{1};
+  for (const tune_param &_param : p_space) {
+    if (_size > std::numeric_limits<std::size_t>::max() / _param.values.size()) {
+      return std::numeric_limits<std::size_t>::max();
+    }
+    _size *= _param.values.size();
+  }
+  return _size;
+}
+
+/// \brief Configuration at position \p p_pos of the grid of \p p_space, where
+/// the last parameter varies faster
+inline tune_config tune_grid_at(const tune_space &p_space, std::size_t p_pos) {
+  std::vector<std::size_t> _indexes(p_space.size());
+  for (std::size_t _i = p_space.size(); _i > 0; --_i) {
+    const std::size_t _count{p_space[_i - 1].values.size()};
+    _indexes[_i - 1] = p_pos % _count;
+    p_pos /= _count;
+  }
+  return tune_config{p_space, std::move(_indexes)};
+}
+
+/// \brief Searches the configuration of \p p_space with the lowest median
+/// time per iteration
+///
+/// \param p_samples number of configurations measured by
+/// \p tune_strategy::random
+///
+/// \param p_repeats number of times each configuration is measured in a
+/// round; the repetitions of all the configurations are interleaved, in a
+/// random order, so that a drift of the machine affects them alike
+///
+/// \param p_measure called as 'double(const tune_config &, std::size_t
+/// p_round)', returns the median nanoseconds per iteration of a configuration
+///
+/// \return the configurations measured, the best first
+///
+/// \throw std::length_error if the space is larger than \p max_tune_grid and
+/// all the configurations must be measured
+///
+/// \throw std::invalid_argument if no configuration would be measured, or if
+/// \p p_repeats is 0
+template <typename t_measure>
+std::vector<tune_trial>
+tune(const tune_space &p_space, tune_strategy p_strategy,
+     std::size_t p_samples, std::size_t p_repeats, std::minstd_rand &p_engine,
+     t_measure &&p_measure) {
+  const std::size_t _grid_size{tune_grid_size(p_space)};
+
+  std::vector<tune_trial> _trials;
+  if ((p_strategy == tune_strategy::random) && (p_samples < _grid_size)) {
+    std::uniform_int_distribution<std::size_t> _pos(0, _grid_size - 1);
+    std::set<std::size_t> _chosen;
+    while (_chosen.size() < p_samples) {
+      _chosen.insert(_pos(p_engine));
+    }
+    for (std::size_t _chosen_pos : _chosen) {
+      _trials.push_back({tune_grid_at(p_space, _chosen_pos), {}, 0, 0});
+    }
+  } else {
+    if (_grid_size > max_tune_grid) {
+      throw std::length_error(
+          "tune space has " + std::to_string(_grid_size) +
+          " configurations, use the random strategy, or reduce the space");
+    }
+    for (std::size_t _i = 0; _i < _grid_size; ++_i) {
+      _trials.push_back({tune_grid_at(p_space, _i), {}, 0, 0});
+    }
+  }
+
+  if (_trials.empty()) {
+    throw std::invalid_argument("tune space has no configuration to measure");
+  }
+  if (p_repeats == 0) {
+    throw std::invalid_argument("configurations must be measured at least "
+                                "once");
+  }
+
+  std::vector<std::size_t> _alive(_trials.size());
+  std::iota(_alive.begin(), _alive.end(), 0);
+
+  auto _by_score = [&](std::size_t p_left, std::size_t p_right) {
+    return _trials[p_left].score < _trials[p_right].score;
+  };
+
+  for (std::size_t _round = 0; !_alive.empty(); ++_round) {
+    for (std::size_t _i : _alive) {
+      _trials[_i].medians.clear();
+    }
+    std::vector<std::size_t> _order{_alive};
+    for (std::size_t _repeat = 0; _repeat < p_repeats; ++_repeat) {
+      std::shuffle(_order.begin(), _order.end(), p_engine);
+      for (std::size_t _i : _order) {
+        _trials[_i].medians.push_back(p_measure(_trials[_i].config, _round));
+      }
+    }
+    for (std::size_t _i : _alive) {
+      std::vector<double> _medians{_trials[_i].medians};
+      _trials[_i].score = compute_stats(_medians).median;
+      _trials[_i].rounds = _round + 1;
+    }
+
+    if ((p_strategy != tune_strategy::halving) || (_alive.size() == 1)) {
+      break;
+    }
+    std::sort(_alive.begin(), _alive.end(), _by_score);
+    _alive.resize(_alive.size() / 2);
+  }
+
+  std::sort(_trials.begin(), _trials.end(),
+            [](const tune_trial &p_left, const tune_trial &p_right) {
+              if (p_left.rounds != p_right.rounds) {
+                return p_left.rounds > p_right.rounds;
+              }
+              return p_left.score < p_right.score;
+            });
+  return _trials;
+}
+
+/// \brief Prints the \p p_top best configurations of a benchmark as a table
+inline void print_tune_text(std::ostream &p_out, std::string_view p_name,
+                            tune_strategy p_strategy, std::size_t p_repeats,
+                            const std::vector<tune_trial> &p_trials,
+                            std::size_t p_top) {
+  using namespace std;
+  p_out << p_name << " TUNE (" << p_strategy << ", " << p_trials.size()
+        << " configurations, " << p_repeats << " repetitions)\n"
+        << "  " << setw(6) << "rank" << setw(14) << "median ns" << setw(8)
+        << "rounds" << "  configuration\n";
+  for (size_t _i = 0; _i < min(p_top, p_trials.size()); ++_i) {
+    const tune_trial &_trial{p_trials[_i]};
+    p_out << "  " << setw(6) << (_i + 1) << fixed << setprecision(1)
+          << setw(14) << _trial.score << defaultfloat << setw(8)
+          << _trial.rounds << "  " << _trial.config << '\n';
+  }
+  p_out << flush;
+}
+
+/// \brief Name of the struct in the header generated for a benchmark
+inline std::string tuned_struct_name(std::string_view p_name) {
+  std::string _name;
+  for (char _c : p_name) {
+    _name += (std::isalnum(static_cast<unsigned char>(_c)) ? _c : '_');
+  }
+  return _name + "_tuned";
+}
+
+/// \brief Writes a header with the best configuration of a benchmark as
+/// 'constexpr' members of a struct named '<benchmark>_tuned'
+inline void write_tuned_header(std::ostream &p_out, std::string_view p_name,
+                               tune_strategy p_strategy,
+                               const tune_trial &p_best) {
+  using namespace std;
+  const string _struct{tuned_struct_name(p_name)};
+  string _guard;
+  for (char _c : _struct) {
+    _guard += static_cast<char>(toupper(static_cast<unsigned char>(_c)));
+  }
+  _guard += "_H";
+
+  p_out << "#ifndef " << _guard << "\n#define " << _guard << "\n\n"
+        << "/// \\brief Best configuration of '" << p_name
+        << "', found by the " << p_strategy << " strategy, " << fixed
+        << setprecision(1) << p_best.score << defaultfloat
+        << " ns per iteration\n"
+        << "///\n/// \\details Generated by tenacitas::lib::test::alg::tester "
+           "'--tune'\n\n"
+        << "#include <cstdint>\n\n"
+        << "struct " << _struct << " {\n";
+
+  const tune_space &_space{p_best.config.space()};
+  for (size_t _i = 0; _i < _space.size(); ++_i) {
+    const tune_param &_param{_space[_i]};
+    p_out << "  static constexpr "
+          << (_param.is_choice() ? "auto " : "std::int64_t ") << _param.name
+          << '{' << _param.text(p_best.config.indexes()[_i]) << "};\n";
+  }
+  p_out << "};\n\n#endif\n" << flush;
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
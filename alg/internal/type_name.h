@@ -0,0 +1,58 @@
+#ifndef TENACITAS_LIB_TEST_ALG_INTERNAL_TYPE_NAME_H
+#define TENACITAS_LIB_TEST_ALG_INTERNAL_TYPE_NAME_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cstdlib>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <cxxabi.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Demangled name of \p t_type, used to identify implementations
+/// compared in a benchmark family
+template <typename t_type> std::string type_name() {
+  const char *_mangled{typeid(t_type).name()};
+  int _status{-1};
+  char *_demangled{abi::__cxa_demangle(_mangled, nullptr, nullptr, &_status)};
+  std::string _name{_status == 0 ? _demangled : _mangled};
+  std::free(_demangled);
+  return _name;
+}
+
+/// \brief Splits a stringized list of types, like "std::map<int, int>,
+/// std::unordered_map<int, int>", at the commas that are not inside '<>' or
+/// '()'
+inline std::vector<std::string> split_type_list(const std::string &p_list) {
+  std::vector<std::string> _types;
+  std::string _cur;
+  int _depth{0};
+  for (char _c : p_list) {
+    if ((_c == '<') || (_c == '(')) {
+      ++_depth;
+    } else if ((_c == '>') || (_c == ')')) {
+      --_depth;
+    } else if ((_c == ',') && (_depth == 0)) {
+      _types.push_back(_cur);
+      _cur.clear();
+      continue;
+    }
+    if (!_cur.empty() || (_c != ' ')) {
+      _cur += _c;
+    }
+  }
+  if (!_cur.empty()) {
+    _types.push_back(_cur);
+  }
+  return _types;
+}
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef TENACITAS_LIB_TEST_ALG_PAGE_BUFFER_H
+#define TENACITAS_LIB_TEST_ALG_PAGE_BUFFER_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace tenacitas::lib::test::alg {
+
+/// \brief Kind of pages that back a \p page_buffer
+enum class page_kind : std::uint8_t {
+  /// \brief Regular pages, usually 4K, with transparent huge pages disabled
+  regular,
+  /// \brief Transparent huge pages, requested with 'madvise(MADV_HUGEPAGE)'
+  transparent_huge,
+  /// \brief Explicit huge pages, from the pool configured in
+  /// '/proc/sys/vm/nr_hugepages'
+  hugetlb
+};
+
+inline std::ostream &operator<<(std::ostream &p_out, page_kind p_kind) {
+  switch (p_kind) {
+  case page_kind::regular:
+    p_out << "regular";
+    break;
+  case page_kind::transparent_huge:
+    p_out << "transparent_huge";
+    break;
+  case page_kind::hugetlb:
+    p_out << "hugetlb";
+    break;
+  }
+  return p_out;
+}
+
+/// \brief Memory for large benchmark inputs, backed by regular or huge pages,
+/// and prefaulted, so that page faults do not happen while the benchmark is
+/// measured
+///
+/// \details If \p page_kind::hugetlb is requested and no huge page is
+/// available, transparent huge pages are used; \p kind() informs the kind of
+/// page actually used.
+///
+/// \code
+/// struct bench_scan {
+///   bench_scan()
+///       : m_buffer(512 * 1024 * 1024, test::alg::page_kind::hugetlb) {}
+///
+///   void operator()(const program::alg::options &) {
+///     const std::uint64_t *_data = m_buffer.as<std::uint64_t>();
+///     for (std::size_t _i = 0; _i < m_buffer.count<std::uint64_t>(); ++_i) {
+///       m_sum += _data[_i];
+///     }
+///   }
+///
+///   static std::string desc() { return "scans 512M backed by huge pages"; }
+///
+///   test::alg::page_buffer m_buffer;
+///   std::uint64_t m_sum{0};
+/// };
+/// \endcode
+struct page_buffer {
+  /// \brief Size of a huge page assumed for alignment
+  static constexpr std::size_t huge_page_size{2 * 1024 * 1024};
+
+  /// \brief Constructor
+  ///
+  /// \param p_size minimum number of bytes; it is rounded up to a multiple of
+  /// the page size
+  ///
+  /// \param p_kind kind of pages requested
+  ///
+  /// \param p_prefault if \p true, every page is written before the
+  /// constructor returns
+  ///
+  /// \throw std::runtime_error if the memory could not be mapped
+  explicit page_buffer(std::size_t p_size,
+                       page_kind p_kind = page_kind::transparent_huge,
+                       bool p_prefault = true)
+      : m_kind(p_kind) {
+    if ((m_kind == page_kind::hugetlb) && !map_hugetlb(p_size)) {
+      m_kind = page_kind::transparent_huge;
+    }
+    if (m_kind != page_kind::hugetlb) {
+      map_anonymous(p_size);
+    }
+    if (p_prefault) {
+      prefault();
+    }
+  }
+
+  page_buffer() = delete;
+  page_buffer(const page_buffer &) = delete;
+  page_buffer &operator=(const page_buffer &) = delete;
+
+  page_buffer(page_buffer &&p_buffer) noexcept
+      : m_kind(p_buffer.m_kind), m_map(p_buffer.m_map),
+        m_map_size(p_buffer.m_map_size), m_data(p_buffer.m_data),
+        m_size(p_buffer.m_size) {
+    p_buffer.m_map = nullptr;
+  }
+
+  page_buffer &operator=(page_buffer &&p_buffer) noexcept {
+    if (this != &p_buffer) {
+      unmap();
+      m_kind = p_buffer.m_kind;
+      m_map = p_buffer.m_map;
+      m_map_size = p_buffer.m_map_size;
+      m_data = p_buffer.m_data;
+      m_size = p_buffer.m_size;
+      p_buffer.m_map = nullptr;
+    }
+    return *this;
+  }
+
+  ~page_buffer() { unmap(); }
+
+  /// \brief Writes one byte in each page, so the kernel allocates all of them
+  /// before they are used
+  ///
+  /// \details Regular page stride is used even for huge pages, because the
+  /// kernel may not be able to provide a transparent huge page
+  void prefault() {
+    const std::size_t _page{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))};
+    volatile std::uint8_t *_bytes{static_cast<std::uint8_t *>(m_data)};
+    for (std::size_t _i = 0; _i < m_size; _i += _page) {
+      _bytes[_i] = 0;
+    }
+  }
+
+  void *data() { return m_data; }
+  const void *data() const { return m_data; }
+
+  std::size_t size() const { return m_size; }
+
+  page_kind kind() const { return m_kind; }
+
+  template <typename t_type> t_type *as() {
+    return static_cast<t_type *>(m_data);
+  }
+
+  template <typename t_type> const t_type *as() const {
+    return static_cast<const t_type *>(m_data);
+  }
+
+  /// \brief Number of objects of \p t_type that fit in the buffer
+  template <typename t_type> std::size_t count() const {
+    return m_size / sizeof(t_type);
+  }
+
+private:
+  static std::size_t round_up(std::size_t p_size, std::size_t p_multiple) {
+    return ((p_size + p_multiple - 1) / p_multiple) * p_multiple;
+  }
+
+  bool map_hugetlb(std::size_t p_size) {
+#ifdef MAP_HUGETLB
+    const std::size_t _size{round_up(p_size, huge_page_size)};
+    void *_map{mmap(nullptr, _size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0)};
+    if (_map == MAP_FAILED) {
+      return false;
+    }
+    m_map = m_data = _map;
+    m_map_size = m_size = _size;
+    return true;
+#else
+    (void)p_size;
+    return false;
+#endif
+  }
+
+  void map_anonymous(std::size_t p_size) {
+    const std::size_t _page{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))};
+    const bool _huge{m_kind == page_kind::transparent_huge};
+
+    // huge pages are only used for regions aligned to the huge page size
+    m_size = round_up(p_size, _huge ? huge_page_size : _page);
+    m_map_size = _huge ? m_size + huge_page_size : m_size;
+
+    m_map = mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m_map == MAP_FAILED) {
+      m_map = nullptr;
+      throw std::runtime_error("could not map " + std::to_string(m_map_size) +
+                               " bytes: " + std::strerror(errno));
+    }
+
+    const auto _addr = reinterpret_cast<std::uintptr_t>(m_map);
+    m_data = reinterpret_cast<void *>(
+        _huge ? round_up(_addr, huge_page_size) : _addr);
+
+#ifdef MADV_HUGEPAGE
+    madvise(m_data, m_size, _huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+#endif
+  }
+
+  void unmap() {
+    if (m_map != nullptr) {
+      munmap(m_map, m_map_size);
+      m_map = nullptr;
+    }
+  }
+
+private:
+  page_kind m_kind;
+  void *m_map{nullptr};
+  std::size_t m_map_size{0};
+  void *m_data{nullptr};
+  std::size_t m_size{0};
+};
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef TENACITAS_LIB_TEST_ALG_PROFILED_MUTEX_H
+#define TENACITAS_LIB_TEST_ALG_PROFILED_MUTEX_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+
+#include <tenacitas.lib.test/alg/internal/lock_profile.h>
+#include <tenacitas.lib.test/alg/internal/tsc.h>
+
+namespace tenacitas::lib::test::alg {
+
+/// \brief Mutex that records how many times it is acquired, how long threads
+/// wait for it, and how long it is held, reported by tester after each test
+///
+/// \details All the mutexes with the same name are reported together. It can
+/// be used with 'std::lock_guard', 'std::unique_lock' and
+/// 'std::condition_variable_any'.
+///
+/// \code
+/// struct test_queue {
+///   bool operator()(const program::alg::options &) {
+///     test::alg::profiled_mutex _mutex{"queue"};
+///     std::vector<std::thread> _threads;
+///     for (int _i = 0; _i < 4; ++_i) {
+///       _threads.emplace_back([&]() {
+///         for (int _j = 0; _j < 1000; ++_j) {
+///           std::lock_guard<test::alg::profiled_mutex> _lock{_mutex};
+///           m_queue.push_back(_j);
+///         }
+///       });
+///     }
+///     for (std::thread &_thread : _threads) {
+///       _thread.join();
+///     }
+///     return m_queue.size() == 4000;
+///   }
+///
+///   static std::string desc() { return "pushes from 4 threads"; }
+///
+///   std::vector<int> m_queue;
+/// };
+/// \endcode
+///
+/// \tparam t_mutex is the mutex wrapped
+template <typename t_mutex = std::mutex> struct basic_profiled_mutex {
+  /// \param p_name must remain valid while the program runs, like a string
+  /// literal
+  ///
+  /// \throw std::length_error if there are more than
+  /// \p internal::max_lock_sites names
+  explicit basic_profiled_mutex(const char *p_name)
+      : m_site(internal::lock_profile::site(p_name)) {}
+
+  basic_profiled_mutex() = delete;
+  basic_profiled_mutex(const basic_profiled_mutex &) = delete;
+  basic_profiled_mutex(basic_profiled_mutex &&) = delete;
+  basic_profiled_mutex &operator=(const basic_profiled_mutex &) = delete;
+  basic_profiled_mutex &operator=(basic_profiled_mutex &&) = delete;
+
+  void lock() {
+    if (m_mutex.try_lock()) {
+      acquired(false, 0);
+      return;
+    }
+    const std::uint64_t _start{internal::tsc()};
+    m_mutex.lock();
+    acquired(true, internal::tsc() - _start);
+  }
+
+  bool try_lock() {
+    if (!m_mutex.try_lock()) {
+      return false;
+    }
+    acquired(false, 0);
+    return true;
+  }
+
+  void unlock() {
+    internal::lock_profile::on_release(m_site,
+                                       internal::tsc() - m_acquired_at);
+    m_mutex.unlock();
+  }
+
+protected:
+  void acquired(bool p_contended, std::uint64_t p_wait_ticks) {
+    internal::lock_profile::on_acquire(m_site, p_contended, p_wait_ticks);
+    m_acquired_at = internal::tsc();
+  }
+
+protected:
+  t_mutex m_mutex;
+  std::size_t m_site;
+  /// \brief When the owner acquired the mutex, only accessed by the owner
+  std::uint64_t m_acquired_at{0};
+};
+
+/// \brief Mutex profiled by tester
+using profiled_mutex = basic_profiled_mutex<std::mutex>;
+
+/// \brief Shared mutex profiled by tester
+///
+/// \details Shared acquisitions are counted, and their waits measured, like
+/// the exclusive ones; the hold time is measured only for exclusive
+/// acquisitions, because shared ones overlap. It can be used with
+/// 'std::shared_lock'.
+struct profiled_shared_mutex : basic_profiled_mutex<std::shared_mutex> {
+  using basic_profiled_mutex<std::shared_mutex>::basic_profiled_mutex;
+
+  void lock_shared() {
+    if (m_mutex.try_lock_shared()) {
+      internal::lock_profile::on_acquire(m_site, false, 0);
+      return;
+    }
+    const std::uint64_t _start{internal::tsc()};
+    m_mutex.lock_shared();
+    internal::lock_profile::on_acquire(m_site, true,
+                                       internal::tsc() - _start);
+  }
+
+  bool try_lock_shared() {
+    if (!m_mutex.try_lock_shared()) {
+      return false;
+    }
+    internal::lock_profile::on_acquire(m_site, false, 0);
+    return true;
+  }
+
+  void unlock_shared() { m_mutex.unlock_shared(); }
+};
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
@@ -0,0 +1,418 @@
+#ifndef TENACITAS_LIB_TEST_ALG_RANDOM_H
+#define TENACITAS_LIB_TEST_ALG_RANDOM_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace tenacitas::lib::test::alg {
+
+namespace internal {
+
+/// \brief Seed passed with '--seed', from which the seed of each test is
+/// derived
+inline std::uint64_t global_seed{0x5eed};
+
+/// \brief Seed of the test, or benchmark, being executed
+inline std::uint64_t current_test_seed{0x5eed};
+
+/// \brief Mixes the bits of \p p_state, and advances it, as in the SplitMix64
+/// generator of Sebastiano Vigna
+inline std::uint64_t splitmix64(std::uint64_t &p_state) {
+  std::uint64_t _z{p_state += 0x9E3779B97F4A7C15};
+  _z = (_z ^ (_z >> 30)) * 0xBF58476D1CE4E5B9;
+  _z = (_z ^ (_z >> 27)) * 0x94D049BB133111EB;
+  return _z ^ (_z >> 31);
+}
+
+/// \brief Seed of a test, from its name and \p global_seed
+inline std::uint64_t seed_of(std::string_view p_test_name) {
+  // FNV-1a
+  std::uint64_t _hash{0xCBF29CE484222325};
+  for (char _c : p_test_name) {
+    _hash ^= static_cast<unsigned char>(_c);
+    _hash *= 0x100000001B3;
+  }
+  std::uint64_t _state{_hash ^ global_seed};
+  return splitmix64(_state);
+}
+
+/// \brief Defines the seed returned by \p test_seed while the test, or
+/// benchmark, \p p_test_name is executed
+inline void seed_test(std::string_view p_test_name) {
+  current_test_seed = seed_of(p_test_name);
+}
+
+inline std::uint64_t rotate_left(std::uint64_t p_value, int p_bits) {
+  return (p_value << p_bits) | (p_value >> (64 - p_bits));
+}
+
+/// \brief High 64 bits of the product of \p p_a and \p p_b
+inline std::uint64_t multiply_high(std::uint64_t p_a, std::uint64_t p_b) {
+  return static_cast<std::uint64_t>((static_cast<__uint128_t>(p_a) * p_b) >>
+                                    64);
+}
+
+/// \brief Maps \p p_bits to [0, 1)
+template <typename t_value> t_value to_unit(std::uint64_t p_bits) {
+  if constexpr (std::is_same_v<t_value, float>) {
+    return static_cast<float>(p_bits >> 40) * 0x1.0p-24f;
+  } else {
+    return static_cast<t_value>(static_cast<double>(p_bits >> 11) * 0x1.0p-53);
+  }
+}
+
+} // namespace internal
+
+/// \brief Seed of the test, or benchmark, being executed by
+/// tenacitas::lib::test::alg::tester
+///
+/// \details It is derived from the name of the test, and from '--seed'
+/// (default 0x5eed), so each test has its own sequence of random values, that
+/// does not change when tests are added, removed or selected with
+/// '--exec { ... }', and all of them change when '--seed' changes
+///
+/// \code
+/// struct test_sort_random {
+///   bool operator()(const program::alg::options &) {
+///     test::alg::wyrand _engine{test::alg::test_seed()};
+///     std::vector<std::uint32_t> _values(1000000);
+///     test::alg::fill_uniform(_engine, _values.data(), _values.size(),
+///                             std::uint32_t{0}, std::uint32_t{1000});
+///     my_sort(_values.begin(), _values.end());
+///     return std::is_sorted(_values.begin(), _values.end());
+///   }
+///
+///   static std::string desc() { return "sorts 1M random integers"; }
+/// };
+/// \endcode
+inline std::uint64_t test_seed() { return internal::current_test_seed; }
+
+/// \brief The wyrand generator of Wang Yi, which passes BigCrush and
+/// PractRand, with 64 bits of state, and one multiplication per value
+///
+/// \details It satisfies 'UniformRandomBitGenerator', so it can be used with
+/// the distributions of the standard library
+struct wyrand {
+  using result_type = std::uint64_t;
+
+  explicit wyrand(std::uint64_t p_seed = test_seed()) : m_state(p_seed) {}
+
+  static constexpr result_type min() { return 0; }
+
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    m_state += 0xA0761D6478BD642F;
+    const __uint128_t _product{static_cast<__uint128_t>(m_state) *
+                               (m_state ^ 0xE7037ED1A0B428DB)};
+    return static_cast<std::uint64_t>(_product >> 64) ^
+           static_cast<std::uint64_t>(_product);
+  }
+
+  /// \brief Writes \p p_size values to \p p_values
+  void fill(std::uint64_t *p_values, std::size_t p_size) {
+    for (std::size_t _i = 0; _i < p_size; ++_i) {
+      p_values[_i] = (*this)();
+    }
+  }
+
+private:
+  std::uint64_t m_state;
+};
+
+/// \brief The xoshiro256++ generator of David Blackman and Sebastiano Vigna,
+/// with 256 bits of state, for tests that need very long sequences, or many
+/// independent ones, with \p jump
+///
+/// \details It satisfies 'UniformRandomBitGenerator'
+struct xoshiro256pp {
+  using result_type = std::uint64_t;
+
+  /// \details The state is initialized with SplitMix64, as recommended by
+  /// the authors, so it is never all zeros
+  explicit xoshiro256pp(std::uint64_t p_seed = test_seed()) {
+    for (std::uint64_t &_word : m_state) {
+      _word = internal::splitmix64(p_seed);
+    }
+  }
+
+  static constexpr result_type min() { return 0; }
+
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    const std::uint64_t _result{
+        internal::rotate_left(m_state[0] + m_state[3], 23) + m_state[0]};
+    const std::uint64_t _t{m_state[1] << 17};
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= _t;
+    m_state[3] = internal::rotate_left(m_state[3], 45);
+    return _result;
+  }
+
+  /// \brief Writes \p p_size values to \p p_values
+  void fill(std::uint64_t *p_values, std::size_t p_size) {
+    for (std::size_t _i = 0; _i < p_size; ++_i) {
+      p_values[_i] = (*this)();
+    }
+  }
+
+  /// \brief Advances 2^128 values, so that copies of a generator, each one
+  /// jumped a different number of times, produce sequences that do not
+  /// overlap, to be used in different threads
+  void jump() {
+    constexpr std::uint64_t _polynomial[]{0x180EC6D33CFD0ABA,
+                                          0xD5A61266F0C9392C,
+                                          0xA9582618E03FC9AA,
+                                          0x39ABDC4529B1661C};
+    std::uint64_t _state[4]{0, 0, 0, 0};
+    for (std::uint64_t _word : _polynomial) {
+      for (int _bit = 0; _bit < 64; ++_bit) {
+        if (_word & (std::uint64_t{1} << _bit)) {
+          for (int _i = 0; _i < 4; ++_i) {
+            _state[_i] ^= m_state[_i];
+          }
+        }
+        (*this)();
+      }
+    }
+    for (int _i = 0; _i < 4; ++_i) {
+      m_state[_i] = _state[_i];
+    }
+  }
+
+private:
+  std::uint64_t m_state[4];
+};
+
+/// \brief Writes \p p_size values uniformly distributed to \p p_values, in
+/// [p_min, p_max] for integers, and in [p_min, p_max) for floating points
+///
+/// \details Integers are mapped to the range with a multiplication, instead
+/// of a division, with a bias smaller than the range divided by 2^64. The
+/// values are produced in the same order by any compiler and standard
+/// library, unlike the distributions of the standard library.
+template <typename t_engine, typename t_value>
+void fill_uniform(t_engine &p_engine, t_value *p_values, std::size_t p_size,
+                  t_value p_min, t_value p_max) {
+  static_assert(std::is_arithmetic_v<t_value>,
+                "only integral and floating point values can be generated");
+  if constexpr (std::is_integral_v<t_value>) {
+    using unsigned_value = std::make_unsigned_t<t_value>;
+    // computed in the unsigned type, as 'p_max - p_min' overflows for the
+    // full range of a signed type
+    const std::uint64_t _range{
+        static_cast<std::uint64_t>(static_cast<unsigned_value>(
+            static_cast<unsigned_value>(p_max) -
+            static_cast<unsigned_value>(p_min)))};
+    if (_range == std::numeric_limits<std::uint64_t>::max()) {
+      for (std::size_t _i = 0; _i < p_size; ++_i) {
+        p_values[_i] = static_cast<t_value>(p_engine());
+      }
+      return;
+    }
+    for (std::size_t _i = 0; _i < p_size; ++_i) {
+      p_values[_i] = static_cast<t_value>(
+          static_cast<unsigned_value>(p_min) +
+          static_cast<unsigned_value>(
+              internal::multiply_high(p_engine(), _range + 1)));
+    }
+  } else {
+    const t_value _width{p_max - p_min};
+    for (std::size_t _i = 0; _i < p_size; ++_i) {
+      p_values[_i] = p_min + internal::to_unit<t_value>(p_engine()) * _width;
+    }
+  }
+}
+
+/// \brief Writes \p p_size values with normal distribution to \p p_values
+///
+/// \details Uniform values are generated first, and transformed in pairs by
+/// the Box-Muller method in a loop without dependencies between iterations,
+/// which the compiler can vectorize when the math functions have vector
+/// versions
+template <typename t_engine, typename t_value>
+void fill_normal(t_engine &p_engine, t_value *p_values, std::size_t p_size,
+                 t_value p_mean, t_value p_stddev) {
+  static_assert(std::is_floating_point_v<t_value>,
+                "only floating point values have normal distribution");
+  constexpr t_value _two_pi{static_cast<t_value>(6.283185307179586476925)};
+  const std::size_t _pairs{p_size / 2};
+  for (std::size_t _i = 0; _i < p_size; ++_i) {
+    p_values[_i] = internal::to_unit<t_value>(p_engine());
+  }
+  for (std::size_t _i = 0; _i < _pairs; ++_i) {
+    // 1 - u is in (0, 1], so its logarithm is finite
+    const t_value _radius{
+        std::sqrt(-2 * std::log(1 - p_values[2 * _i])) * p_stddev};
+    const t_value _angle{_two_pi * p_values[2 * _i + 1]};
+    p_values[2 * _i] = p_mean + _radius * std::cos(_angle);
+    p_values[2 * _i + 1] = p_mean + _radius * std::sin(_angle);
+  }
+  if (p_size % 2) {
+    const t_value _radius{
+        std::sqrt(-2 * std::log(1 - p_values[p_size - 1])) * p_stddev};
+    p_values[p_size - 1] =
+        p_mean +
+        _radius * std::cos(_two_pi * internal::to_unit<t_value>(p_engine()));
+  }
+}
+
+/// \brief Zipf distribution of ranks from 1 to \p items, where the
+/// probability of rank k is proportional to 1 / k^exponent
+///
+/// \details It uses the rejection-inversion method of Wolfgang Hörmann and
+/// Gerhard Derflinger, "Rejection-inversion to generate variates from
+/// monotone discrete distributions", 1996, which needs no table, and
+/// rejects few values, so it can be used with millions of items
+struct zipf_distribution {
+  /// \throw std::invalid_argument if \p p_items is 0, or \p p_exponent is
+  /// not positive
+  zipf_distribution(std::uint64_t p_items, double p_exponent)
+      : m_items(p_items), m_exponent(p_exponent) {
+    if ((p_items == 0) || !(p_exponent > 0)) {
+      throw std::invalid_argument(
+          "zipf distribution requires items > 0 and exponent > 0");
+    }
+    m_integral_x1 = integral(1.5) - 1;
+    m_integral_items = integral(static_cast<double>(p_items) + 0.5);
+    m_s = 2 - integral_inverse(integral(2.5) - h(2));
+  }
+
+  /// \return a rank from 1 to \p items
+  template <typename t_engine> std::uint64_t operator()(t_engine &p_engine) {
+    while (true) {
+      const double _u{m_integral_items +
+                      internal::to_unit<double>(p_engine()) *
+                          (m_integral_x1 - m_integral_items)};
+      const double _x{integral_inverse(_u)};
+      double _k{std::floor(_x + 0.5)};
+      if (_k < 1) {
+        _k = 1;
+      } else if (_k > static_cast<double>(m_items)) {
+        _k = static_cast<double>(m_items);
+      }
+      if ((_k - _x <= m_s) || (_u >= integral(_k + 0.5) - h(_k))) {
+        return static_cast<std::uint64_t>(_k);
+      }
+    }
+  }
+
+private:
+  double h(double p_x) const { return std::exp(-m_exponent * std::log(p_x)); }
+
+  double integral(double p_x) const {
+    const double _log_x{std::log(p_x)};
+    return helper2((1 - m_exponent) * _log_x) * _log_x;
+  }
+
+  double integral_inverse(double p_x) const {
+    double _t{p_x * (1 - m_exponent)};
+    if (_t < -1) {
+      _t = -1;
+    }
+    return std::exp(helper1(_t) * p_x);
+  }
+
+  /// \brief log(1 + x) / x, precise near 0
+  static double helper1(double p_x) {
+    if (std::fabs(p_x) > 1e-8) {
+      return std::log1p(p_x) / p_x;
+    }
+    return 1 - p_x * (0.5 - p_x * (1.0 / 3.0 - 0.25 * p_x));
+  }
+
+  /// \brief (exp(x) - 1) / x, precise near 0
+  static double helper2(double p_x) {
+    if (std::fabs(p_x) > 1e-8) {
+      return std::expm1(p_x) / p_x;
+    }
+    return 1 + p_x * 0.5 * (1 + p_x * (1.0 / 3.0) * (1 + 0.25 * p_x));
+  }
+
+private:
+  std::uint64_t m_items;
+  double m_exponent;
+  double m_integral_x1;
+  double m_integral_items;
+  double m_s;
+};
+
+/// \brief Writes \p p_size keys from 0 to \p p_items - 1 with Zipf
+/// distribution to \p p_keys
+///
+/// \param p_scrambled if \p true, the popular keys are spread over the key
+/// space, by hashing the ranks, as the popular keys of real workloads rarely
+/// are consecutive; the frequency of each key is kept, but popular keys may
+/// collide
+template <typename t_engine, typename t_key>
+void fill_zipf(t_engine &p_engine, t_key *p_keys, std::size_t p_size,
+               std::uint64_t p_items, double p_exponent,
+               bool p_scrambled = false) {
+  static_assert(std::is_integral_v<t_key>, "keys must be integral");
+  zipf_distribution _zipf{p_items, p_exponent};
+  for (std::size_t _i = 0; _i < p_size; ++_i) {
+    std::uint64_t _rank{_zipf(p_engine) - 1};
+    if (p_scrambled) {
+      std::uint64_t _state{_rank};
+      _rank = internal::splitmix64(_state) % p_items;
+    }
+    p_keys[_i] = static_cast<t_key>(_rank);
+  }
+}
+
+/// \brief Writes \p p_size keys from 0 to \p p_items - 1 to \p p_keys, where
+/// \p p_hot_probability of them are uniformly chosen among the first
+/// \p p_hot_fraction of the keys, and the others among the remaining keys
+///
+/// \details It is the "hotspot" distribution of the Yahoo! Cloud Serving
+/// Benchmark; with a fraction of 0.2, and a probability of 0.8, 80% of the
+/// accesses go to 20% of the keys
+template <typename t_engine, typename t_key>
+void fill_hotspot(t_engine &p_engine, t_key *p_keys, std::size_t p_size,
+                  std::uint64_t p_items, double p_hot_fraction,
+                  double p_hot_probability) {
+  static_assert(std::is_integral_v<t_key>, "keys must be integral");
+  if ((p_items == 0) || !(p_hot_fraction >= 0) || !(p_hot_fraction <= 1) ||
+      !(p_hot_probability >= 0) || !(p_hot_probability <= 1)) {
+    throw std::invalid_argument("hotspot distribution requires items > 0, "
+                                "and fraction and probability in [0, 1]");
+  }
+  const std::uint64_t _hot{std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(static_cast<double>(p_items) *
+                                    p_hot_fraction))};
+  const std::uint64_t _cold{p_items - std::min(_hot, p_items)};
+  const std::uint64_t _threshold{
+      p_hot_probability < 1
+          ? static_cast<std::uint64_t>(p_hot_probability * 0x1.0p64)
+          : std::numeric_limits<std::uint64_t>::max()};
+  for (std::size_t _i = 0; _i < p_size; ++_i) {
+    const bool _is_hot{(p_engine() < _threshold) || (_cold == 0)};
+    const std::uint64_t _bits{p_engine()};
+    p_keys[_i] = static_cast<t_key>(
+        _is_hot ? internal::multiply_high(_bits, _hot)
+                : _hot + internal::multiply_high(_bits, _cold));
+  }
+}
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
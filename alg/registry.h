@@ -0,0 +1,122 @@
+#ifndef TENACITAS_LIB_TEST_ALG_REGISTRY_H
+#define TENACITAS_LIB_TEST_ALG_REGISTRY_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <string>
+#include <string_view>
+
+#include <tenacitas.lib.test/alg/internal/io_budget.h>
+
+namespace tenacitas::lib::program::alg {
+struct options;
+} // namespace tenacitas::lib::program::alg
+
+namespace tenacitas::lib::test::alg {
+
+/// \brief Registers a test, to be executed by
+/// tenacitas::lib::test::alg::tester::run_registered
+///
+/// \param test_class is the name of a class that implements what 'run_test'
+/// requires
+///
+/// \details It is used at namespace scope, in translation units that include
+/// only this header, and not tenacitas.lib.test/alg/tester.h, which is
+/// included only by the translation unit that executes the tests, like
+/// tenacitas.lib.test/alg/test_main.h
+///
+/// \code
+/// #include <string>
+///
+/// #include <tenacitas.lib.test/alg/registry.h>
+///
+/// using namespace tenacitas::lib;
+///
+/// struct test_parse {
+///   bool operator()(const program::alg::options &) { return true; }
+///
+///   static constexpr std::string_view desc() { return "parses a number"; }
+/// };
+///
+/// register_test(test_parse);
+/// \endcode
+#define register_test(test_class)                                              \
+  [[maybe_unused]] static const bool tenacitas_registered_##test_class {       \
+    tenacitas::lib::test::alg::registry::add<test_class>(#test_class)          \
+  }
+
+/// \brief A test registered with 'register_test'
+struct registered_test {
+  std::string_view name;
+
+  /// \brief Builds the description of the test; it is passed to the
+  /// reporter, which calls it only if it prints the description, so
+  /// executing a registered test allocates nothing for it
+  std::string (*desc)();
+
+  /// \brief Creates the test object, and executes it
+  bool (*run)(const program::alg::options &);
+
+  /// \brief Budgets for the counters of '/proc/self/io'
+  internal::io_budget budgets;
+
+  registered_test *next{nullptr};
+};
+
+/// \brief Tests registered with 'register_test', in the order they were
+/// registered in each translation unit
+///
+/// \details The list is built while the static variables are initialized,
+/// so 'register_test' must not be used inside functions, and the tests must
+/// be executed after 'main' starts
+struct registry {
+  template <typename t_test_class> static bool add(std::string_view p_name) {
+    static registered_test _test{
+        p_name,
+        []() { return std::string{t_test_class::desc()}; },
+        [](const program::alg::options &p_options) {
+          t_test_class _test_obj;
+          return static_cast<bool>(_test_obj(p_options));
+        },
+        internal::io_budgets<t_test_class>()};
+    // a test registered in many translation units is added once
+    static const bool _added{append(_test)};
+    return _added;
+  }
+
+  /// \brief Calls \p p_visitor with each registered test
+  template <typename t_visitor> static void for_each(t_visitor &&p_visitor) {
+    for (registered_test *_test = head(); _test != nullptr;
+         _test = _test->next) {
+      p_visitor(static_cast<const registered_test &>(*_test));
+    }
+  }
+
+private:
+  static bool append(registered_test &p_test) {
+    if (tail() == nullptr) {
+      head() = &p_test;
+    } else {
+      tail()->next = &p_test;
+    }
+    tail() = &p_test;
+    return true;
+  }
+
+  static registered_test *&head() {
+    static registered_test *_head{nullptr};
+    return _head;
+  }
+
+  static registered_test *&tail() {
+    static registered_test *_tail{nullptr};
+    return _tail;
+  }
+};
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef TENACITAS_LIB_TEST_ALG_TEST_MAIN_H
+#define TENACITAS_LIB_TEST_ALG_TEST_MAIN_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+/// \brief Defines 'main', which executes the tests registered with
+/// 'register_test' with tenacitas::lib::test::alg::tester, accepting all of
+/// its options, including the ones of tenacitas.lib.test/alg/tester_modes.h
+///
+/// \details It must be included in exactly one translation unit of the test
+/// program, which is the only one that compiles tenacitas.lib.test/alg/tester.h;
+/// the others include only tenacitas.lib.test/alg/registry.h
+
+#include <exception>
+#include <iostream>
+
+#include <tenacitas.lib.test/alg/tester.h>
+#include <tenacitas.lib.test/alg/tester_modes.h>
+
+int main(int argc, char **argv) {
+  try {
+    tenacitas::lib::test::alg::tester _tester(argc, argv);
+    _tester.run_registered();
+  } catch (std::exception &_ex) {
+    std::cout << "EXCEPTION: '" << _ex.what() << "'" << std::endl;
+  }
+}
+
+#endif
@@ -6,10 +6,39 @@
 
 /// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
 #include <initializer_list>
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <tenacitas.lib.program/alg/options.h>
+#include <tenacitas.lib.test/alg/bench_state.h>
+#include <tenacitas.lib.test/alg/check.h>
+#include <tenacitas.lib.test/alg/internal/bench_report.h>
+#include <tenacitas.lib.test/alg/internal/bench_stats.h>
+#include <tenacitas.lib.test/alg/internal/cache.h>
+#include <tenacitas.lib.test/alg/internal/dataset_directory.h>
+#include <tenacitas.lib.test/alg/internal/load_generator.h>
+#include <tenacitas.lib.test/alg/internal/mode_hooks.h>
+#include <tenacitas.lib.test/alg/internal/result_log.h>
+#include <tenacitas.lib.test/alg/internal/tuner.h>
+#include <tenacitas.lib.test/alg/internal/type_name.h>
+#include <tenacitas.lib.test/alg/random.h>
+#include <tenacitas.lib.test/alg/registry.h>
+#include <tenacitas.lib.test/alg/tester_policies.h>
 
 /// \brief classes to help creating testing programs to test other classes
 namespace tenacitas::lib::test::alg {
@@ -29,10 +58,112 @@ namespace tenacitas::lib::test::alg {
 ///
 #define run_test(tester, test) tester.run<test>(#test)
 
+/// \brief Runs a test evaluated while the program is compiled
+///
+/// \param tester is an instance of tenacitas::lib::test::alg::tester defined
+/// below
+///
+/// \param test is the name of a class that implements
+///
+/// \code
+/// static constexpr bool check()
+///
+/// static std::string desc()
+/// \endcode
+///
+/// If \p check returns \p false, or can not be evaluated at compile time, the
+/// program does not compile
+#define run_constexpr_test(tester, test)                                       \
+  static_assert(test::check(), "'" #test "' failed at compile time");          \
+  tester.run_constexpr<test>(#test)
+
+/// \brief Runs a benchmark
+///
+/// \param tester is an instance of tenacitas::lib::test::alg::tester defined
+/// below
+///
+/// \param benchmark is the name of a class that implements
+///
+/// \code
+/// void operator()(const program::alg::options &)
+///
+/// static std::string desc()
+/// \endcode
+///
+/// where \p operator() is one iteration of the benchmark. \p operator() can
+/// also receive a tenacitas::lib::test::alg::bench_state, to pause and resume
+/// timing, or to use inputs prepared in batches
+#define run_bench(tester, benchmark) tester.bench<benchmark>(#benchmark)
+
+/// \brief Runs a benchmark against many implementations of the same interface
+///
+/// \param tester is an instance of tenacitas::lib::test::alg::tester defined
+/// below
+///
+/// \param family is the name of a class that implements
+///
+/// \code
+/// template <typename t_impl>
+/// void operator()(t_impl &, test::alg::bench_state &)
+///
+/// static std::string desc()
+/// \endcode
+///
+/// \param ... are the implementations compared, the first being the
+/// reference
+#define run_bench_family(tester, family, ...)                                  \
+  tester.bench_family<family, __VA_ARGS__>(#family, #__VA_ARGS__)
+
+/// \brief Runs a benchmark whose parameters can be tuned
+///
+/// \param tester is an instance of tenacitas::lib::test::alg::tester defined
+/// below
+///
+/// \param benchmark is the name of a class that implements, besides what
+/// 'run_bench' requires,
+///
+/// \code
+/// static test::alg::tune_space tune_space()
+/// \endcode
+///
+/// and reads the parameters with tenacitas::lib::test::alg::bench_state::param
+#define run_tune(tester, benchmark) tester.tune<benchmark>(#benchmark)
+
+/// \brief Runs a benchmark at fixed rates of calls per second
+///
+/// \param tester is an instance of tenacitas::lib::test::alg::tester defined
+/// below
+///
+/// \param benchmark is the name of a class that implements what 'run_bench'
+/// requires, where \p operator() is one call, like a request handled
+#define run_load(tester, benchmark) tester.load<benchmark>(#benchmark)
+
 /// \brief The test struct executes tests implemented in classes
 ///
-/// \tparam use makes tenacitas::lib::test::alg::tester to be compiled only if
-/// actually used
+/// \tparam t_scheduler decides which tests and benchmarks are executed, like
+/// tenacitas::lib::test::alg::options_scheduler or
+/// tenacitas::lib::test::alg::all_scheduler
+///
+/// \tparam t_reporter prints the results, like
+/// tenacitas::lib::test::alg::stream_reporter or
+/// tenacitas::lib::test::alg::quiet_reporter
+///
+/// \tparam t_timer times the iterations of the benchmarks, like
+/// tenacitas::lib::test::alg::tsc_timer or
+/// tenacitas::lib::test::alg::steady_timer
+///
+/// \tparam t_instrumentation measures each test, like
+/// tenacitas::lib::test::alg::full_instrumentation or
+/// tenacitas::lib::test::alg::no_instrumentation, whose functions are empty,
+/// so nothing is measured, and the cost of executing a test is the cost of
+/// calling it
+///
+/// The default policies implement all the options described in the
+/// constructor, and are deduced when no template argument is written, as in
+/// 'test::alg::tester _tester(argc, argv)'. Other combinations are written
+/// as 'test::alg::tester<test::alg::all_scheduler, test::alg::quiet_reporter,
+/// test::alg::tsc_timer, test::alg::no_instrumentation>', like
+/// tenacitas::lib::test::alg::lean_tester
 ///
 /// \code
 /// #include <iostream>
@@ -80,7 +211,10 @@ namespace tenacitas::lib::test::alg {
 ///}
 ///
 /// \endcode
-template <bool use = true> struct tester {
+template <typename t_scheduler = options_scheduler,
+          typename t_reporter = stream_reporter, typename t_timer = tsc_timer,
+          typename t_instrumentation = full_instrumentation>
+struct tester {
 
   /// \brief Constructor
   /// If '--desc' is passed, \p operator() will print a description of the
@@ -88,6 +222,60 @@ template <bool use = true> struct tester {
   /// If '--exec' is passed, \p operator() will execute the tests
   /// If '--exec { <test-name-1> <test-name-2> ... }' is passed, \p operator()
   /// will execute the tests between '{' and '}'
+  /// If '--leak-check' is also passed, the allocations alive after each test
+  /// are compared to the ones alive before it, and the test fails if there is
+  /// a difference. It requires tenacitas.lib.test/alg/hook_allocator.h to be
+  /// included in the test program. '--leak-sample <n>' records the call stack
+  /// of one in every 'n' allocations, instead of all of them
+  /// If '--heap-profile' is also passed, allocations are sampled every
+  /// '--heap-sample <bytes>' bytes in average (default 524288), and the
+  /// '--heap-top <n>' (default 10) call stacks that allocated more bytes, and
+  /// more times, are printed after each test. It also requires
+  /// tenacitas.lib.test/alg/hook_allocator.h
+  /// '--seed <n>' (default 0x5eed) changes the seeds returned by
+  /// tenacitas::lib::test::alg::test_seed, each derived from it and from the
+  /// name of the test, and the random order of the implementations of
+  /// benchmark families
+  /// '--dataset-cache <dir>' (default '$TMPDIR/tenacitas.lib.test.datasets')
+  /// is where the datasets of tenacitas::lib::test::alg::cached_dataset are
+  /// kept between runs
+  /// Benchmarks are executed '--bench-iterations <n>' times (default 1000).
+  /// If '--cold-cache' is passed, they are also executed with the caches
+  /// evicted before each iteration, by streaming through a buffer of
+  /// '--cold-cache-bytes <n>' bytes (default 3 times the size of the last
+  /// level cache), and the results are reported side by side
+  /// If '--tlb-counters' is passed, the TLB misses and page faults per
+  /// iteration of each benchmark are also reported, if the system allows
+  /// reading them. tenacitas::lib::test::alg::page_buffer helps comparing
+  /// regular and huge pages
+  /// If '--bench-json' is passed, each benchmark result is printed as a JSON
+  /// object in one line, instead of text
+  /// If '--bench-only' is passed, tests are not executed, only benchmarks
+  /// If '--ab { <old-program> <new-program> }' is passed, no test is executed;
+  /// instead, the two programs, usually two builds of the same benchmarks, are
+  /// executed '--ab-batches <n>' (default 10) times each, alternately, pinned
+  /// to '--ab-cpu <n>' (default the current CPU), executing the benchmarks in
+  /// '--ab-bench { <name-1> <name-2> ... }' (default all), and the medians of
+  /// each batch are compared. It requires
+  /// tenacitas.lib.test/alg/tester_modes.h to be included in the test program
+  /// If '--tune' is passed, the benchmarks executed with 'run_tune' have their
+  /// parameters searched with the '--tune-strategy <grid|random|halving>'
+  /// (default grid), measuring '--tune-samples <n>' (default 16) random
+  /// configurations, or all of them, '--tune-repeats <n>' (default 5) times,
+  /// with '--tune-iterations <n>' (default 100) iterations each; the best
+  /// configuration is written as a header in the directory
+  /// '--tune-output <dir>', or printed. These options are read when the first
+  /// benchmark is executed with 'run_tune'
+  /// Benchmarks executed with 'run_load' are called at each rate in
+  /// '--load-rates { <calls-per-second-1> ... }' (default fractions of the
+  /// rate a closed loop achieves) during '--load-duration <ms>' (default 1000),
+  /// read when the first of them is executed
+  /// If '--result-log <file>' is passed, the result of each test and
+  /// benchmark is written to 'file', mapped in memory, so that the results
+  /// survive a crash, which is recorded with the call stack of the crashing
+  /// code. If '--result-log-print <file>' is passed, nothing is executed, and
+  /// the results in 'file' are printed, which also requires
+  /// tenacitas.lib.test/alg/tester_modes.h
   ///
   /// \param argc number of strings in \p argv
   ///
@@ -102,26 +290,71 @@ template <bool use = true> struct tester {
 
       m_options.parse(m_argc, m_argv, std::move(p_mandatory));
 
-      if (m_options.get_bool_param("exec")) {
-        m_execute_tests = true;
-      } else if (m_options.get_bool_param("desc")) {
-        m_print_desc = true;
-      } else {
-        std::optional<std::list<program::alg::options::value>> _maybe =
-            m_options.get_set_param("exec");
-        if (_maybe) {
-          m_execute_tests = true;
-          std::list<program::alg::options::value> _tests_to_exec =
-              std::move(*_maybe);
-          m_tests_to_exec.insert(_tests_to_exec.begin(), _tests_to_exec.end());
+      m_scheduler.configure(m_options);
+
+      std::optional<program::alg::options::value> _maybe_log_print =
+          m_options.get_single_param("result-log-print");
+      if (_maybe_log_print) {
+        m_scheduler.cancel();
+        if (internal::mode_hooks::result_log_print == nullptr) {
+          throw std::runtime_error(
+              "'--result-log-print' requires "
+              "'tenacitas.lib.test/alg/tester_modes.h' to be included in the "
+              "test program");
+        }
+        internal::mode_hooks::result_log_print(std::cout, *_maybe_log_print);
+        return;
+      }
+
+      // also used by '--ab', which passes them to the programs compared
+      std::optional<program::alg::options::value> _maybe_iterations =
+          m_options.get_single_param("bench-iterations");
+      if (_maybe_iterations) {
+        m_bench_iterations = std::stoul(*_maybe_iterations);
+      }
+
+      m_cold_cache = m_options.get_bool_param("cold-cache");
+      if (m_cold_cache) {
+        std::optional<program::alg::options::value> _maybe_bytes =
+            m_options.get_single_param("cold-cache-bytes");
+        if (_maybe_bytes) {
+          m_cold_cache_bytes = std::stoul(*_maybe_bytes);
+        }
+      }
+
+      if (m_options.get_set_param("ab")) {
+        m_scheduler.cancel();
+        if (internal::mode_hooks::ab == nullptr) {
+          throw std::runtime_error(
+              "'--ab' requires 'tenacitas.lib.test/alg/tester_modes.h' to be "
+              "included in the test program");
         }
+        internal::mode_hooks::ab(m_options, m_bench_iterations, m_cold_cache,
+                                 m_cold_cache_bytes);
+        return;
       }
 
-      if ((!m_execute_tests) && (!m_print_desc)) {
+      if ((!m_scheduler.execute()) && (!m_scheduler.describe())) {
         print_mini_howto();
       }
+
+      m_reporter.configure(m_options);
+      m_instrumentation.configure(m_options);
+
+      std::optional<program::alg::options::value> _maybe_seed =
+          m_options.get_single_param("seed");
+      if (_maybe_seed) {
+        internal::global_seed = std::stoull(*_maybe_seed, nullptr, 0);
+        m_bench_seed = static_cast<std::uint_fast32_t>(internal::global_seed);
+      }
+
+      std::optional<program::alg::options::value> _maybe_dataset_cache =
+          m_options.get_single_param("dataset-cache");
+      if (_maybe_dataset_cache) {
+        internal::dataset_directory = *_maybe_dataset_cache;
+      }
     } catch (std::exception &_ex) {
-      std::cout << "EXCEPTION '" << _ex.what() << "'" << std::endl;
+      m_reporter.exception(_ex.what());
       return;
     }
   }
@@ -154,57 +387,654 @@ template <bool use = true> struct tester {
   /// static std::string desc()
   /// \endcode
   ///
+  /// \p desc can also return a 'std::string_view' or a 'const char *', and be
+  /// 'constexpr', so that executing the test does not build a string; if the
+  /// name is a literal, as in 'run_test', nothing is allocated to execute the
+  /// test, besides what the test itself, and the policies, allocate
+  ///
+  /// It can also define budgets for the I/O counters of '/proc/self/io',
+  /// and the test fails if it exceeds any of them:
+  /// \code
+  /// static constexpr std::size_t max_rchar{<n>};
+  /// static constexpr std::size_t max_wchar{<n>};
+  /// static constexpr std::size_t max_syscr{<n>};
+  /// static constexpr std::size_t max_syscw{<n>};
+  /// static constexpr std::size_t max_read_bytes{<n>};
+  /// static constexpr std::size_t max_write_bytes{<n>};
+  /// \endcode
+  ///
   /// \details You can use the macro 'run_test' defined above, instead of
   /// calling this method
   template <typename t_test_class>
-  void run(const std::string &p_test_name) noexcept {
+  void run(std::string_view p_test_name) noexcept {
     using namespace std;
     try {
-      if (m_print_desc) {
-        cout << p_test_name << ": " << t_test_class::desc() << "\n" << endl;
+      if (m_scheduler.describe()) {
+        m_reporter.describe(p_test_name, t_test_class::desc());
         return;
       }
 
-      if (m_execute_tests) {
-        if (!m_tests_to_exec.empty()) {
-          if ((std::find(m_tests_to_exec.begin(), m_tests_to_exec.end(),
-                         p_test_name)) != m_tests_to_exec.end()) {
-            exec<t_test_class>(p_test_name);
-          }
+      if (m_scheduler.test_selected(p_test_name)) {
+        exec<t_test_class>(p_test_name);
+      }
+    } catch (std::exception &_ex) {
+      m_reporter.exception(_ex.what());
+      return;
+    }
+  }
+
+  /// \brief Lists a test that was evaluated while the program was compiled
+  ///  The message "<name> COMPILE-TIME PASS" is printed, as the test did not
+  /// compile otherwise, so it costs nothing when the program runs
+  ///
+  /// \tparam t_test_class must implement:
+  /// \code
+  /// static constexpr bool check()
+  ///
+  /// static std::string desc()
+  /// \endcode
+  ///
+  /// \details You can use the macro 'run_constexpr_test' defined above, instead
+  /// of calling this method, which also names the test when it fails
+  template <typename t_test_class>
+  void run_constexpr(std::string_view p_test_name) noexcept {
+    static_assert(t_test_class::check(), "test failed at compile time");
+    try {
+      if (m_scheduler.describe()) {
+        m_reporter.describe(p_test_name, t_test_class::desc());
+        return;
+      }
+
+      if (m_scheduler.test_selected(p_test_name)) {
+        m_instrumentation.begin(p_test_name);
+        m_reporter.compile_time_pass(p_test_name);
+        m_instrumentation.end(internal::result_status::success);
+      }
+    } catch (std::exception &_ex) {
+      m_reporter.exception(_ex.what());
+    }
+  }
+
+  /// \brief Executes the tests registered with 'register_test', as \p run
+  /// does
+  ///
+  /// \details The tests can be registered in translation units that include
+  /// only tenacitas.lib.test/alg/registry.h, which compile faster than the
+  /// ones that include this header
+  void run_registered() noexcept {
+    registry::for_each([this](const registered_test &p_test) {
+      try {
+        if (m_scheduler.describe()) {
+          m_reporter.describe(p_test.name, p_test.desc);
+          return;
+        }
+
+        if (m_scheduler.test_selected(p_test.name)) {
+          exec(p_test);
+        }
+      } catch (std::exception &_ex) {
+        m_reporter.exception(_ex.what());
+      }
+    });
+  }
+
+  /// \brief Executes the benchmark
+  /// The time of each iteration is measured, and the message "<name> BENCH"
+  /// followed by the median, mean, minimum, 99th percentile and maximum
+  /// nanoseconds per iteration will be printed, followed by the rates of the
+  /// values reported through tenacitas::lib::test::alg::bench_state, one per
+  /// line; if an error occurr while
+  /// executing the benchmark, the message "ERROR for <name> <desc>" will be
+  /// printed
+  ///
+  /// \tparam t_bench_class must implement:
+  /// \code
+  /// void operator()(const program::alg::options &)
+  ///
+  /// static std::string desc()
+  /// \endcode
+  ///
+  /// or, instead of the first method
+  /// \code
+  /// void operator()(test::alg::bench_state &)
+  /// \endcode
+  ///
+  /// \details You can use the macro 'run_bench' defined above, instead of
+  /// calling this method. The object of \p t_bench_class is created once, so
+  /// the data used by all the iterations can be prepared in its constructor
+  template <typename t_bench_class>
+  void bench(std::string_view p_bench_name) noexcept {
+    using namespace std;
+    try {
+      if (m_scheduler.describe()) {
+        m_reporter.describe(p_bench_name, t_bench_class::desc());
+        return;
+      }
+
+      if (m_scheduler.bench_selected(p_bench_name)) {
+        exec_bench<t_bench_class>(p_bench_name);
+      }
+    } catch (std::exception &_ex) {
+      m_reporter.exception(_ex.what());
+      return;
+    }
+  }
+
+  /// \brief Executes a benchmark against many implementations
+  /// In each round, one iteration of each implementation is executed, in a
+  /// random order, so that drifts of the machine affect all of them alike.
+  /// The message "<name> BENCH FAMILY" is printed, followed by a table with
+  /// the median and mean nanoseconds per iteration of each implementation, and
+  /// how many times it is faster than the first implementation, with a 95%
+  /// confidence interval
+  ///
+  /// \tparam t_family must implement:
+  /// \code
+  /// template <typename t_impl>
+  /// void operator()(t_impl &, test::alg::bench_state &)
+  ///
+  /// static std::string desc()
+  /// \endcode
+  /// Its object is created once, and all the implementations use the same
+  /// inputs, so \p operator() must not change them; \p setup and
+  /// \p batch_size, as described in tenacitas::lib::test::alg::bench_state,
+  /// are called once per round for all the implementations
+  ///
+  /// \tparam t_impls are default constructible implementations, created once
+  /// and passed to every iteration; the first one is the reference
+  ///
+  /// \param p_impl_names comma separated names of the implementations; if
+  /// empty, the demangled names of the types are used
+  ///
+  /// \details You can use the macro 'run_bench_family' defined above, instead
+  /// of calling this method
+  template <typename t_family, typename... t_impls>
+  void bench_family(std::string_view p_family_name,
+                    std::string_view p_impl_names = "") noexcept {
+    using namespace std;
+    static_assert(sizeof...(t_impls) > 0,
+                  "at least one implementation must be compared");
+    try {
+      vector<string> _names{internal::split_type_list(string{p_impl_names})};
+      if (_names.size() != sizeof...(t_impls)) {
+        _names = {internal::type_name<t_impls>()...};
+      }
+
+      if (m_scheduler.describe()) {
+        string _desc{string{t_family::desc()} + ", comparing"};
+        for (const string &_name : _names) {
+          _desc += " '" + _name + "'";
+        }
+        m_reporter.describe(p_family_name, _desc);
+        return;
+      }
+
+      if (m_scheduler.bench_selected(p_family_name)) {
+        exec_bench_family<t_family, t_impls...>(
+            p_family_name, _names, index_sequence_for<t_impls...>{});
+      }
+    } catch (std::exception &_ex) {
+      m_reporter.exception(_ex.what());
+      return;
+    }
+  }
+
+  /// \brief Executes a benchmark whose parameters can be tuned
+  /// If '--tune' is passed, the configurations of the parameters are measured
+  /// as described in the constructor, the message "<name> TUNE" is printed,
+  /// followed by a table with the best configurations, and the best one is
+  /// written as a header, with a struct named '<name>_tuned' with a
+  /// 'static constexpr' member for each parameter; otherwise, the benchmark
+  /// is executed as in \p bench, with the first value of each parameter
+  ///
+  /// \tparam t_bench_class must implement what \p bench requires, and
+  /// \code
+  /// static test::alg::tune_space tune_space()
+  /// \endcode
+  ///
+  /// \details You can use the macro 'run_tune' defined above, instead of
+  /// calling this method
+  template <typename t_bench_class>
+  void tune(std::string_view p_bench_name) noexcept {
+    using namespace std;
+    try {
+      const tune_space _space{t_bench_class::tune_space()};
+      if (m_scheduler.describe()) {
+        string _desc{string{t_bench_class::desc()} + ", tuning"};
+        for (const tune_param &_param : _space) {
+          _desc += " '" + _param.name + "'";
+        }
+        m_reporter.describe(p_bench_name, _desc);
+        return;
+      }
+
+      if (m_scheduler.bench_selected(p_bench_name)) {
+        if (!m_tune) {
+          m_tune = internal::tune_settings::parse(m_options);
+        }
+        if (m_tune->enabled) {
+          exec_tune<t_bench_class>(p_bench_name, _space);
         } else {
-          exec<t_test_class>(p_test_name);
+          const tune_config _first{_space,
+                                   vector<size_t>(_space.size(), 0)};
+          exec_bench<t_bench_class>(p_bench_name, &_first);
+        }
+      }
+    } catch (std::exception &_ex) {
+      m_reporter.exception(_ex.what());
+      return;
+    }
+  }
+
+  /// \brief Executes a benchmark at fixed rates of calls per second
+  /// Each call is issued at its intended time, even if the previous ones have
+  /// not finished, and its latency is measured from that time, so the time
+  /// waiting in line is included. The message "<name> LOAD" is printed,
+  /// followed by a table with the percentiles of the latency at each rate,
+  /// and the highest rate before the latency grows disproportionately, or
+  /// the calls per second achieved fall behind the target
+  ///
+  /// \tparam t_bench_class must implement what \p bench requires; the calls
+  /// are executed in the same thread, one at a time
+  ///
+  /// \details You can use the macro 'run_load' defined above, instead of
+  /// calling this method
+  template <typename t_bench_class>
+  void load(std::string_view p_bench_name) noexcept {
+    using namespace std;
+    try {
+      if (m_scheduler.describe()) {
+        m_reporter.describe(p_bench_name, t_bench_class::desc());
+        return;
+      }
+
+      if (m_scheduler.bench_selected(p_bench_name)) {
+        if (!m_load) {
+          m_load = internal::load_settings::parse(m_options);
         }
+        exec_load<t_bench_class>(p_bench_name);
       }
     } catch (std::exception &_ex) {
-      std::cout << "EXCEPTION '" << _ex.what() << "'" << std::endl;
+      m_reporter.exception(_ex.what());
       return;
     }
   }
 
 private:
-  /// \brief Executes the test
+  /// \brief Executes the test, and prints how its wall time was spent: on a
+  /// CPU, waiting for one, or blocked, and the I/O it did
   /// \tparam t_test_class must implement:
   /// \code
   /// bool operator()(const program::alg::options &)
   ///
   /// static std::string desc()
   /// \endcode
-  template <typename t_test_class> void exec(const std::string p_test_name) {
-    using namespace std;
+  ///
+  /// \details Only the creation of the test object, and the report of its
+  /// beginning, are compiled for each test; the rest is compiled once
+  template <typename t_test_class> void exec(std::string_view p_test_name) {
+    const registered_test _test{
+        p_test_name, nullptr,
+        [](const program::alg::options &p_options) {
+          t_test_class _test_obj;
+          return static_cast<bool>(_test_obj(p_options));
+        },
+        internal::io_budgets<t_test_class>()};
+    exec(_test, [](t_reporter &p_reporter, const registered_test &p_begun) {
+      p_reporter.template begin<t_test_class>(p_begun.name);
+    });
+  }
+
+  /// \brief Executes a test registered with 'register_test'
+  void exec(const registered_test &p_test) {
+    exec(p_test, [](t_reporter &p_reporter, const registered_test &p_begun) {
+      p_reporter.begin(p_begun.name, p_begun.desc);
+    });
+  }
+
+  /// \brief Executes a test
+  ///
+  /// \param p_begin reports the beginning of the test
+  void exec(const registered_test &p_test,
+            void (*p_begin)(t_reporter &, const registered_test &)) {
     bool result = false;
+    internal::result_status _status{internal::result_status::error};
+    try {
+      p_begin(m_reporter, p_test);
+      m_instrumentation.begin(p_test.name);
+      internal::seed_test(p_test.name);
+      m_instrumentation.before_test();
+      const internal::assertion_snapshot _assertions;
+
+      result = p_test.run(m_options) && (_assertions.failed() == 0);
+
+      result =
+          m_instrumentation.after_test(p_test.name, result, p_test.budgets);
+      m_reporter.assertions(p_test.name, _assertions.checked(),
+                            _assertions.failed());
+      m_reporter.result(p_test.name, result);
+      _status = (result ? internal::result_status::success
+                        : internal::result_status::fail);
+    } catch (std::exception &_ex) {
+      m_instrumentation.abort_test();
+      m_reporter.error(p_test.name, _ex.what());
+    }
+    m_instrumentation.end(_status);
+    m_reporter.end(p_test.name);
+  }
+
+  /// \brief Executes the benchmark, with warm caches and, if required, with
+  /// cold caches
+  ///
+  /// \param p_config values of the parameters of a benchmark executed with
+  /// 'run_tune'
+  template <typename t_bench_class>
+  void exec_bench(std::string_view p_bench_name,
+                  const tune_config *p_config = nullptr) {
+    using namespace std;
+    internal::result_status _status{internal::result_status::error};
+    try {
+      m_reporter.template begin<t_bench_class>(p_bench_name);
+      m_instrumentation.begin(p_bench_name);
+      internal::seed_test(p_bench_name);
+
+      t_bench_class _bench_obj;
+
+      vector<internal::bench_result> _results;
+      _results.push_back(measure(_bench_obj, "warm", nullptr,
+                                 m_bench_iterations, p_config));
+
+      string _note;
+      if (m_cold_cache) {
+        if (!m_evictor) {
+          m_evictor = make_unique<internal::cache_evictor>(m_cold_cache_bytes);
+        }
+        _results.push_back(measure(_bench_obj, "cold", m_evictor.get(),
+                                   m_bench_iterations, p_config));
+        _note = "evicting " + to_string(m_evictor->size()) + " bytes";
+      }
+
+      m_reporter.bench(p_bench_name, _results, _note);
+      _status = internal::result_status::success;
+    } catch (exception &_ex) {
+      m_reporter.error(p_bench_name, _ex.what());
+    }
+    m_instrumentation.end(_status);
+    m_reporter.end(p_bench_name);
+  }
+
+  /// \brief Executes a benchmark at each rate of calls per second
+  template <typename t_bench_class>
+  void exec_load(std::string_view p_bench_name) {
+    using namespace std;
+    internal::result_status _status{internal::result_status::error};
+    try {
+      m_reporter.template begin<t_bench_class>(p_bench_name);
+      m_instrumentation.begin(p_bench_name);
+      internal::seed_test(p_bench_name);
+
+      t_bench_class _bench_obj;
+      const double _service_ns{measure(_bench_obj, "closed", nullptr,
+                                       m_load_calibration)
+                                   .stats.mean};
+
+      vector<double> _rates{m_load->rates};
+      if (_rates.empty()) {
+        const double _capacity{1e9 / max(_service_ns, 1.0)};
+        for (double _fraction : m_load_fractions) {
+          _rates.push_back(_fraction * _capacity);
+        }
+      }
+
+      constexpr size_t _batch_size{
+          internal::bench_batch_size<t_bench_class>::value};
+      internal::bench_state_driver<t_timer> _state(m_options, _batch_size);
+
+      vector<internal::load_point> _points;
+      for (double _rate : _rates) {
+        _points.push_back(internal::open_loop(
+            _rate, m_load->duration, [&](size_t p_call) {
+              _state.set_iteration(p_call);
+              if constexpr (internal::bench_has_setup<t_bench_class>::value) {
+                if ((p_call % _batch_size) == 0) {
+                  _bench_obj.setup(_state);
+                }
+              }
+              internal::bench_iteration(_bench_obj, _state);
+            }));
+      }
+
+      m_reporter.load(p_bench_name, _service_ns, m_load->duration, _points);
+      _status = internal::result_status::success;
+    } catch (exception &_ex) {
+      m_reporter.error(p_bench_name, _ex.what());
+    }
+    m_instrumentation.end(_status);
+    m_reporter.end(p_bench_name);
+  }
+
+  /// \brief Searches the best configuration of the parameters of a benchmark
+  template <typename t_bench_class>
+  void exec_tune(std::string_view p_bench_name, const tune_space &p_space) {
+    using namespace std;
+    internal::result_status _status{internal::result_status::error};
+    try {
+      m_reporter.template begin<t_bench_class>(p_bench_name);
+      m_instrumentation.begin(p_bench_name);
+      internal::seed_test(p_bench_name);
+
+      t_bench_class _bench_obj;
+      minstd_rand _engine{m_bench_seed};
+
+      const vector<internal::tune_trial> _trials{internal::tune(
+          p_space, m_tune->strategy, m_tune->samples, m_tune->repeats, _engine,
+          [&](const tune_config &p_config, size_t p_round) {
+            return measure(_bench_obj, "tune", nullptr,
+                           m_tune->iterations << p_round, &p_config)
+                .stats.median;
+          })};
+
+      string _path;
+      if (!m_tune->output.empty()) {
+        _path = m_tune->output + '/' +
+                internal::tuned_struct_name(p_bench_name) + ".h";
+        ofstream _file{_path};
+        if (!_file) {
+          throw runtime_error("could not create '" + _path + "'");
+        }
+        internal::write_tuned_header(_file, p_bench_name, m_tune->strategy,
+                                     _trials.front());
+      }
+      m_reporter.tune(p_bench_name, m_tune->strategy, m_tune->repeats, _trials,
+                      m_tune_top, _path);
+      _status = internal::result_status::success;
+    } catch (exception &_ex) {
+      m_reporter.error(p_bench_name, _ex.what());
+    }
+    m_instrumentation.end(_status);
+    m_reporter.end(p_bench_name);
+  }
+
+  /// \brief Measures each iteration of a benchmark
+  ///
+  /// \param p_mode identifies the result, like "warm" or "cold"
+  ///
+  /// \param p_evictor if not \p nullptr, it is called before each iteration,
+  /// out of the measured interval
+  ///
+  /// \param p_iterations number of iterations measured
+  ///
+  /// \param p_config values of the parameters, if the benchmark is executed
+  /// with 'run_tune'
+  template <typename t_bench_class>
+  internal::bench_result measure(t_bench_class &p_bench,
+                                 const std::string &p_mode,
+                                 internal::cache_evictor *p_evictor,
+                                 std::size_t p_iterations,
+                                 const tune_config *p_config = nullptr) {
+    constexpr std::size_t _batch_size{
+        internal::bench_batch_size<t_bench_class>::value};
+
+    internal::bench_state_driver<t_timer> _state(m_options, _batch_size);
+    _state.set_tune_config(p_config);
+
+    auto _setup = [&](std::size_t p_iteration) {
+      _state.set_iteration(p_iteration);
+      if constexpr (internal::bench_has_setup<t_bench_class>::value) {
+        if ((p_iteration % _batch_size) == 0) {
+          p_bench.setup(_state);
+        }
+      }
+    };
+
+    for (std::size_t _i = 0; _i < m_bench_warmup; ++_i) {
+      _setup(_i);
+      _state.start();
+      internal::bench_iteration(p_bench, _state);
+      _state.stop();
+    }
+    _state.reset_counters();
+
+    std::vector<double> _ns;
+    _ns.reserve(p_iterations);
+
+    internal::bench_result _result;
+    _result.mode = p_mode;
+
+    if constexpr (t_instrumentation::enabled) {
+      std::unique_ptr<internal::perf_counters> _counters{
+          m_instrumentation.bench_counters()};
+
+      for (std::size_t _i = 0; _i < p_iterations; ++_i) {
+        _setup(_i);
+        if (p_evictor != nullptr) {
+          (*p_evictor)();
+        }
+        if (_counters) {
+          _counters->enable();
+        }
+        _state.start();
+        internal::bench_iteration(p_bench, _state);
+        _ns.push_back(_state.stop());
+        if (_counters) {
+          _counters->disable();
+        }
+      }
+
+      _result.stats = internal::compute_stats(_ns);
+      if (_counters && (_result.stats.iterations != 0)) {
+        _counters->for_each(
+            [&](const char *p_name, bool p_available, std::uint64_t p_value) {
+              _result.events.push_back(
+                  {p_name, p_available,
+                   static_cast<double>(p_value) /
+                       static_cast<double>(_result.stats.iterations)});
+            });
+      }
+    } else {
+      for (std::size_t _i = 0; _i < p_iterations; ++_i) {
+        _setup(_i);
+        if (p_evictor != nullptr) {
+          (*p_evictor)();
+        }
+        _state.start();
+        internal::bench_iteration(p_bench, _state);
+        _ns.push_back(_state.stop());
+      }
+      _result.stats = internal::compute_stats(_ns);
+    }
+
+    _result.rates = internal::make_rates(_state, _result.stats);
+    return _result;
+  }
+
+  /// \brief Executes rounds of interleaved iterations of the implementations
+  /// of a benchmark family
+  template <typename t_family, typename... t_impls, std::size_t... t_idx>
+  void exec_bench_family(std::string_view p_family_name,
+                         const std::vector<std::string> &p_impl_names,
+                         std::index_sequence<t_idx...>) {
+    using namespace std;
+    internal::result_status _status{internal::result_status::error};
     try {
-      t_test_class _test_obj;
-      cerr << "\n############ -> " << p_test_name << " - "
-           << t_test_class::desc() << endl;
-      result = _test_obj(m_options);
-      //            cout << (result ? "SUCCESS" : "FAIL") << " for " <<
-      //            p_test_name
-      //                 << endl;
-      cout << p_test_name << (result ? " SUCCESS" : " FAIL") << endl;
+      m_reporter.template begin<t_family>(p_family_name);
+      m_instrumentation.begin(p_family_name);
+      internal::seed_test(p_family_name);
+
+      constexpr size_t _num_impls{sizeof...(t_impls)};
+      constexpr size_t _batch_size{
+          internal::bench_batch_size<t_family>::value};
+
+      using impls = tuple<t_impls...>;
+      using driver = internal::bench_state_driver<t_timer>;
+      using iteration = double (*)(t_family &, impls &, driver &);
+
+      t_family _family;
+      impls _impls;
+      const array<iteration, _num_impls> _iterations{
+          &internal::family_iteration<t_idx, t_family, impls, driver>...};
+
+      vector<unique_ptr<driver>> _states;
+      for (size_t _i = 0; _i < _num_impls; ++_i) {
+        _states.push_back(make_unique<driver>(m_options, _batch_size));
+      }
+
+      vector<vector<double>> _ns(_num_impls);
+      for (vector<double> &_impl_ns : _ns) {
+        _impl_ns.reserve(m_bench_iterations);
+      }
+
+      array<size_t, _num_impls> _order;
+      iota(_order.begin(), _order.end(), 0);
+      minstd_rand _engine{m_bench_seed};
+
+      auto _round = [&](size_t p_round, bool p_measured) {
+        for (unique_ptr<driver> &_state : _states) {
+          _state->set_iteration(p_round);
+        }
+        if constexpr (internal::bench_has_setup<t_family>::value) {
+          if ((p_round % _batch_size) == 0) {
+            _family.setup(*_states.front());
+          }
+        }
+        shuffle(_order.begin(), _order.end(), _engine);
+        for (size_t _impl : _order) {
+          const double _elapsed{
+              _iterations[_impl](_family, _impls, *_states[_impl])};
+          if (p_measured) {
+            _ns[_impl].push_back(_elapsed);
+          }
+        }
+      };
+
+      for (size_t _round_idx = 0; _round_idx < m_bench_warmup; ++_round_idx) {
+        _round(_round_idx, false);
+      }
+      for (unique_ptr<driver> &_state : _states) {
+        _state->reset_counters();
+      }
+      for (size_t _round_idx = 0; _round_idx < m_bench_iterations;
+           ++_round_idx) {
+        _round(_round_idx, true);
+      }
+
+      vector<internal::bench_result> _results(_num_impls);
+      for (size_t _i = 0; _i < _num_impls; ++_i) {
+        internal::bench_result &_result{_results[_i]};
+        _result.mode = p_impl_names[_i];
+        _result.speedup = internal::compute_speedup(_ns.front(), _ns[_i]);
+        vector<double> _sorted{_ns[_i]};
+        _result.stats = internal::compute_stats(_sorted);
+        _result.rates = internal::make_rates(*_states[_i], _result.stats);
+      }
+
+      m_reporter.family(p_family_name, _results);
+      _status = internal::result_status::success;
     } catch (exception &_ex) {
-      cout << "ERROR for " << p_test_name << " '" << _ex.what() << "'" << endl;
+      m_reporter.error(p_family_name, _ex.what());
     }
-    cerr << "############ <- " << p_test_name << endl;
+    m_instrumentation.end(_status);
+    m_reporter.end(p_family_name);
   }
 
   /// \brief print_mini_howto prints a mini how-to for using the \p test class
@@ -217,6 +1047,68 @@ private:
          << "\t'" << m_pgm_name
          << " --exec { <test-name-1> <test-name-2> ...}' will execute tests "
             "defined between '{' and '}'\n"
+         << "\t'" << m_pgm_name
+         << " --exec --leak-check [--leak-sample <n>]' will also report "
+            "allocations not released by each test, sampling the call stack "
+            "of one in every 'n' allocations (default 1); requires "
+            "'tenacitas.lib.test/alg/hook_allocator.h' to be included\n"
+         << "\t'" << m_pgm_name
+         << " --exec --heap-profile [--heap-sample <bytes>] [--heap-top <n>]' "
+            "will also print the 'n' (default 10) call stacks that allocated "
+            "more bytes and more times in each test, sampling one allocation "
+            "every 'bytes' (default 524288) in average; requires "
+            "'tenacitas.lib.test/alg/hook_allocator.h' to be included\n"
+         << "\t'" << m_pgm_name
+         << " --exec [--bench-iterations <n>]' will execute benchmarks 'n' "
+            "times (default 1000)\n"
+         << "\t'" << m_pgm_name
+         << " --exec --seed <n>' will derive the seed of each test, returned "
+            "by 'tenacitas::lib::test::alg::test_seed', from 'n' (default "
+            "0x5eed) and the name of the test\n"
+         << "\t'" << m_pgm_name
+         << " --exec --dataset-cache <dir>' will keep the datasets of "
+            "'tenacitas::lib::test::alg::cached_dataset' in 'dir' (default "
+            "'$TMPDIR/tenacitas.lib.test.datasets'), to be mapped by the next "
+            "runs instead of generated again\n"
+         << "\t'" << m_pgm_name
+         << " --exec --cold-cache [--cold-cache-bytes <n>]' will also execute "
+            "benchmarks after evicting the caches with a buffer of 'n' bytes "
+            "(default 3 times the size of the last level cache), and print "
+            "warm and cold results side by side\n"
+         << "\t'" << m_pgm_name
+         << " --exec --tlb-counters' will also print TLB misses and page "
+            "faults per iteration of benchmarks\n"
+         << "\t'" << m_pgm_name
+         << " --exec --bench-json' will print each benchmark result as a JSON "
+            "object in one line\n"
+         << "\t'" << m_pgm_name
+         << " --exec --bench-only' will execute only the benchmarks\n"
+         << "\t'" << m_pgm_name
+         << " --ab { <old> <new> } [--ab-batches <n>] [--ab-cpu <n>] "
+            "[--ab-bench { <name-1> ... }] [--bench-iterations <n>] "
+            "[--cold-cache [--cold-cache-bytes <n>]]' will "
+            "execute the benchmarks of the programs 'old' and 'new' "
+            "alternately, 'n' batches (default 10) each, pinned to the same "
+            "cpu, and report significant differences; requires "
+            "'tenacitas.lib.test/alg/tester_modes.h' to be included\n"
+         << "\t'" << m_pgm_name
+         << " --exec --tune [--tune-strategy <grid|random|halving>] "
+            "[--tune-samples <n>] [--tune-repeats <n>] [--tune-iterations <n>] "
+            "[--tune-output <dir>]' will search the best parameters of the "
+            "benchmarks executed with 'run_tune', and write them as "
+            "'constexpr' in a header\n"
+         << "\t'" << m_pgm_name
+         << " --exec [--load-rates { <r-1> <r-2> ... }] [--load-duration "
+            "<ms>]' will call the benchmarks executed with 'run_load' at each "
+            "rate of calls per second during 'ms' (default 1000) "
+            "milliseconds, and print the latency percentiles\n"
+         << "\t'" << m_pgm_name
+         << " --exec --result-log <file>' will also write the results to "
+            "'file', which keeps them, and the call stack of a crash, even if "
+            "the program crashes\n"
+         << "\t'" << m_pgm_name
+         << " --result-log-print <file>' will print the results in 'file'; "
+            "requires 'tenacitas.lib.test/alg/tester_modes.h' to be included\n"
          << "\t'" << m_pgm_name << "' displays this message\n\n"
          << "For the programmers: \n"
          << "\t1 - Programmers should use 'std::cerr' to print messages\n"
@@ -224,7 +1116,14 @@ private:
             "displayed, "
             "use\n"
          << "\t'" << m_pgm_name
-         << " --exec 2> /dev/null' to execute the tests\n\n"
+         << " --exec 2> /dev/null' to execute the tests\n"
+         << "\t3 - After each test, its wall time is printed, split in cpu, "
+            "run queue and blocked time of the thread that executed it, "
+            "followed by the cpu time of the other threads, and the I/O it "
+            "did, from '/proc/self/io'\n"
+         << "\t4 - Mutexes of type 'tenacitas::lib::test::alg::profiled_mutex' "
+            "have their acquisitions, waits and hold times printed after each "
+            "test\n\n"
          << "Output:\n"
          << "\tIf the test passes, the message \"SUCCESS for <name>\" will "
             "be "
@@ -236,6 +1135,12 @@ private:
          << "\tIf an error occurr while executing the test , the message "
             "\"ERROR "
             "for <name> <desc>\" will be printed\n"
+         << "\tIf the test used 'check_that' or 'expect_that', the message "
+            "\"ASSERTIONS for <name>: checked <n>, failed <n>\" will be "
+            "printed\n"
+         << "\tIf the test was evaluated at compile time, with "
+            "'run_constexpr_test', the message \"<name> COMPILE-TIME PASS\" "
+            "will be printed\n"
          << "\tIf an exception occurrs, the message \"EXCEPTION "
             "<description>\" "
             "will be printed"
@@ -246,25 +1151,69 @@ private:
   /// \brief Name of the test program
   std::string m_pgm_name;
 
-  /// \brief Indicates if the tests should actually be executed, or if theirs
-  /// description should be printed
-  bool m_execute_tests = {false};
-
-  /// \brief Prints test decription to \p cout
-  bool m_print_desc = {false};
-
   /// \brief Number of parameters passed to the \p test object
   int m_argc = {-1};
 
   /// \brief Parameters passed to the \p test object
   char **m_argv = {nullptr};
 
-  /// \brief Set of tests to execute
-  std::set<std::string> m_tests_to_exec;
+  /// \brief Number of measured iterations of each benchmark
+  std::size_t m_bench_iterations = {1000};
+
+  /// \brief Number of iterations executed before measuring a benchmark
+  std::size_t m_bench_warmup = {10};
+
+  /// \brief Seed of the random order of the implementations in a benchmark
+  /// family, defined by '--seed'
+  std::uint_fast32_t m_bench_seed = {0x5eed};
+
+  /// \brief Benchmarks are also executed with the caches evicted before each
+  /// iteration
+  bool m_cold_cache = {false};
+
+  /// \brief Size of the buffer used to evict the caches; if 0,
+  /// internal::cache_eviction_factor times the size of the last level cache
+  std::size_t m_cold_cache_bytes = {0};
+
+  /// \brief Options of 'run_tune', read when the first benchmark is tuned,
+  /// so that programs that tune nothing do not compile them
+  std::optional<internal::tune_settings> m_tune;
+
+  /// \brief Number of the best configurations printed
+  static constexpr std::size_t m_tune_top{5};
+
+  /// \brief Options of 'run_load', read when the first load benchmark is
+  /// executed
+  std::optional<internal::load_settings> m_load;
+
+  /// \brief Number of calls in closed loop that estimate the time of a call
+  /// of a load benchmark
+  static constexpr std::size_t m_load_calibration{200};
+
+  /// \brief Fractions of the rate achieved in closed loop used when no rate
+  /// is informed
+  static constexpr std::array<double, 9> m_load_fractions{
+      0.1, 0.25, 0.5, 0.7, 0.8, 0.9, 0.95, 1.0, 1.1};
+
+  /// \brief Evicts the caches, created in the first benchmark executed with
+  /// cold caches
+  std::unique_ptr<internal::cache_evictor> m_evictor;
 
   program::alg::options m_options;
+
+  t_scheduler m_scheduler;
+
+  t_reporter m_reporter;
+
+  t_instrumentation m_instrumentation;
 };
 
+/// \brief Tester that executes every test, prints only the failures, and
+/// measures nothing, so that executing a test costs little more than calling
+/// it
+using lean_tester =
+    tester<all_scheduler, quiet_reporter, tsc_timer, no_instrumentation>;
+
 } // namespace tenacitas::lib::test::alg
 
 #endif
@@ -0,0 +1,100 @@
+#ifndef TENACITAS_LIB_TEST_ALG_TESTER_MODES_H
+#define TENACITAS_LIB_TEST_ALG_TESTER_MODES_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+/// \brief Installs the options of tenacitas::lib::test::alg::tester that
+/// execute no test: '--ab', which compares the benchmarks of two programs,
+/// and '--result-log-print', which prints the results written with
+/// '--result-log'
+///
+/// \attention Include this file in the translation unit that creates the
+/// tester, usually the one that defines \p main; without it, these options
+/// report an error. tenacitas.lib.test/alg/test_main.h includes it.
+///
+/// \code
+/// #include <tenacitas.lib.test/alg/tester.h>
+/// #include <tenacitas.lib.test/alg/tester_modes.h>
+/// \endcode
+
+#include <cstddef>
+#include <iostream>
+#include <list>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sched.h>
+
+#include <tenacitas.lib.program/alg/options.h>
+#include <tenacitas.lib.test/alg/internal/ab_driver.h>
+#include <tenacitas.lib.test/alg/internal/mode_hooks.h>
+#include <tenacitas.lib.test/alg/internal/result_log.h>
+
+namespace tenacitas::lib::test::alg::internal {
+
+/// \brief Compares the benchmarks of two programs, executing them
+/// alternately as child processes
+///
+/// \param p_options must have '--ab' with the old and the new programs, in
+/// this order
+inline void run_ab(const program::alg::options &p_options,
+                   std::size_t p_bench_iterations, bool p_cold_cache,
+                   std::size_t p_cold_cache_bytes) {
+  using namespace std;
+  optional<list<program::alg::options::value>> _maybe_programs{
+      p_options.get_set_param("ab")};
+  if ((!_maybe_programs) || (_maybe_programs->size() != 2)) {
+    throw runtime_error("'--ab' requires two programs");
+  }
+
+  size_t _batches{10};
+  optional<program::alg::options::value> _maybe_batches{
+      p_options.get_single_param("ab-batches")};
+  if (_maybe_batches) {
+    _batches = stoul(*_maybe_batches);
+  }
+
+  int _cpu{sched_getcpu()};
+  optional<program::alg::options::value> _maybe_cpu{
+      p_options.get_single_param("ab-cpu")};
+  if (_maybe_cpu) {
+    _cpu = stoi(*_maybe_cpu);
+  }
+
+  vector<string> _args{"--exec"};
+  optional<list<program::alg::options::value>> _maybe_bench{
+      p_options.get_set_param("ab-bench")};
+  if (_maybe_bench) {
+    _args.push_back("{");
+    _args.insert(_args.end(), _maybe_bench->begin(), _maybe_bench->end());
+    _args.push_back("}");
+  }
+  _args.insert(_args.end(),
+               {"--bench-only", "--bench-json", "--bench-iterations",
+                to_string(p_bench_iterations)});
+  if (p_cold_cache) {
+    _args.push_back("--cold-cache");
+    if (p_cold_cache_bytes != 0) {
+      _args.insert(_args.end(),
+                   {"--cold-cache-bytes", to_string(p_cold_cache_bytes)});
+    }
+  }
+
+  ab_driver _driver(_maybe_programs->front(), _maybe_programs->back(),
+                    move(_args), _batches, _cpu);
+  _driver(cout);
+}
+
+static const bool tester_modes_installed{
+    (mode_hooks::ab = run_ab, mode_hooks::result_log_print = result_log::print,
+     true)};
+
+} // namespace tenacitas::lib::test::alg::internal
+
+#endif
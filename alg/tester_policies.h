@@ -0,0 +1,601 @@
+#ifndef TENACITAS_LIB_TEST_ALG_TESTER_POLICIES_H
+#define TENACITAS_LIB_TEST_ALG_TESTER_POLICIES_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <tenacitas.lib.program/alg/options.h>
+#include <tenacitas.lib.test/alg/internal/alloc_hooks.h>
+#include <tenacitas.lib.test/alg/internal/bench_report.h>
+#include <tenacitas.lib.test/alg/internal/io_stats.h>
+#include <tenacitas.lib.test/alg/internal/load_generator.h>
+#include <tenacitas.lib.test/alg/internal/lock_profile.h>
+#include <tenacitas.lib.test/alg/internal/perf_counters.h>
+#include <tenacitas.lib.test/alg/internal/result_log.h>
+#include <tenacitas.lib.test/alg/internal/sched_stats.h>
+#include <tenacitas.lib.test/alg/internal/tsc.h>
+#include <tenacitas.lib.test/alg/internal/tuner.h>
+
+/// \brief Policies that configure tenacitas::lib::test::alg::tester at
+/// compile time
+///
+/// \details A scheduler policy decides which tests and benchmarks are
+/// executed, a reporter policy prints their results, a timer policy reads the
+/// clock that times the iterations of benchmarks, and an instrumentation
+/// policy measures each test. Policies that are not needed can be replaced by
+/// ones whose functions are empty, and the code of the features disappears
+/// from the test program.
+namespace tenacitas::lib::test::alg {
+
+/// \brief Scheduler policy that selects the tests and benchmarks from the
+/// options '--exec', '--exec { <name-1> ... }', '--desc' and '--bench-only'
+struct options_scheduler {
+  void configure(const program::alg::options &p_options) {
+    if (p_options.get_bool_param("exec")) {
+      m_execute = true;
+    } else if (p_options.get_bool_param("desc")) {
+      m_describe = true;
+    } else {
+      std::optional<std::list<program::alg::options::value>> _maybe =
+          p_options.get_set_param("exec");
+      if (_maybe) {
+        m_execute = true;
+        m_selected.insert(_maybe->begin(), _maybe->end());
+      }
+    }
+    m_bench_only = p_options.get_bool_param("bench-only");
+  }
+
+  /// \brief Nothing is executed or described, because the program does
+  /// something else, like comparing two programs
+  void cancel() {
+    m_execute = false;
+    m_describe = false;
+  }
+
+  /// \brief Informs if the tests and benchmarks are described, instead of
+  /// executed
+  bool describe() const { return m_describe; }
+
+  /// \brief Informs if any test or benchmark can be executed
+  bool execute() const { return m_execute; }
+
+  bool test_selected(std::string_view p_name) const {
+    return !m_bench_only && bench_selected(p_name);
+  }
+
+  bool bench_selected(std::string_view p_name) const {
+    return m_execute &&
+           (m_selected.empty() || (m_selected.find(p_name) != m_selected.end()));
+  }
+
+private:
+  bool m_execute{false};
+  bool m_describe{false};
+  bool m_bench_only{false};
+  /// \brief 'std::less<>' allows searching without creating a 'std::string'
+  std::set<std::string, std::less<>> m_selected;
+};
+
+/// \brief Scheduler policy that executes every test and benchmark, whatever
+/// the options passed to the program
+struct all_scheduler {
+  void configure(const program::alg::options &) {}
+
+  void cancel() { m_cancelled = true; }
+
+  bool describe() const { return false; }
+
+  bool execute() const { return !m_cancelled; }
+
+  bool test_selected(std::string_view) const { return !m_cancelled; }
+
+  bool bench_selected(std::string_view) const { return !m_cancelled; }
+
+private:
+  bool m_cancelled{false};
+};
+
+/// \brief Reporter policy that prints the results to 'std::cout', and the
+/// begin and end of each test and benchmark to 'std::cerr'
+///
+/// \details If '--bench-json' is passed, benchmark results are printed as a
+/// JSON object in one line
+struct stream_reporter {
+  void configure(const program::alg::options &p_options) {
+    m_json = p_options.get_bool_param("bench-json");
+  }
+
+  void describe(std::string_view p_name, std::string_view p_desc) {
+    std::cout << p_name << ": " << p_desc << "\n" << std::endl;
+  }
+
+  /// \param p_desc builds the description of a test registered with
+  /// 'register_test', and is called only by reporters that print it
+  void describe(std::string_view p_name, std::string (*p_desc)()) {
+    describe(p_name, p_desc());
+  }
+
+  /// \tparam t_described implements 'static desc()', called only here, so
+  /// reporters that do not print it do not build it
+  template <typename t_described> void begin(std::string_view p_name) {
+    begin(p_name, t_described::desc());
+  }
+
+  void begin(std::string_view p_name, std::string_view p_desc) {
+    std::cerr << "\n############ -> " << p_name << " - " << p_desc
+              << std::endl;
+  }
+
+  /// \param p_desc builds the description of a test registered with
+  /// 'register_test', and is called only by reporters that print it
+  void begin(std::string_view p_name, std::string (*p_desc)()) {
+    begin(p_name, p_desc());
+  }
+
+  void end(std::string_view p_name) {
+    std::cerr << "############ <- " << p_name << std::endl;
+  }
+
+  /// \brief Checks executed by a test with 'check_that' and 'expect_that',
+  /// printed only if there was any
+  void assertions(std::string_view p_name, std::uint64_t p_checked,
+                  std::uint64_t p_failed) {
+    if ((p_checked != 0) || (p_failed != 0)) {
+      std::cout << "ASSERTIONS for " << p_name << ": checked " << p_checked
+                << ", failed " << p_failed << std::endl;
+    }
+  }
+
+  void result(std::string_view p_name, bool p_success) {
+    std::cout << p_name << (p_success ? " SUCCESS" : " FAIL") << std::endl;
+  }
+
+  /// \brief A test evaluated while the program was compiled
+  void compile_time_pass(std::string_view p_name) {
+    std::cout << p_name << " COMPILE-TIME PASS" << std::endl;
+  }
+
+  void error(std::string_view p_name, const char *p_what) {
+    std::cout << "ERROR for " << p_name << " '" << p_what << "'" << std::endl;
+  }
+
+  void exception(const char *p_what) {
+    std::cout << "EXCEPTION '" << p_what << "'" << std::endl;
+  }
+
+  void bench(std::string_view p_name,
+             const std::vector<internal::bench_result> &p_results,
+             const std::string &p_note) {
+    if (m_json) {
+      for (const internal::bench_result &_result : p_results) {
+        internal::print_json(std::cout, p_name, _result);
+      }
+    } else {
+      internal::print_text(std::cout, p_name, p_results, p_note);
+    }
+  }
+
+  void family(std::string_view p_name,
+              const std::vector<internal::bench_result> &p_results) {
+    if (m_json) {
+      for (const internal::bench_result &_result : p_results) {
+        internal::print_json(std::cout, p_name, _result);
+      }
+    } else {
+      internal::print_family_text(std::cout, p_name, p_results);
+    }
+  }
+
+  void load(std::string_view p_name, double p_service_ns,
+            std::chrono::milliseconds p_duration,
+            const std::vector<internal::load_point> &p_points) {
+    if (m_json) {
+      for (const internal::load_point &_point : p_points) {
+        internal::print_load_json(std::cout, p_name, _point);
+      }
+    } else {
+      internal::print_load_text(std::cout, p_name, p_service_ns, p_duration,
+                                p_points);
+    }
+  }
+
+  /// \param p_path where the tuned header was written; if empty, it is
+  /// printed
+  void tune(std::string_view p_name, internal::tune_strategy p_strategy,
+            std::size_t p_repeats,
+            const std::vector<internal::tune_trial> &p_trials,
+            std::size_t p_top, const std::string &p_path) {
+    internal::print_tune_text(std::cout, p_name, p_strategy, p_repeats,
+                              p_trials, p_top);
+    if (p_path.empty()) {
+      internal::write_tuned_header(std::cout, p_name, p_strategy,
+                                   p_trials.front());
+    } else {
+      std::cout << "  written to '" << p_path << "'" << std::endl;
+    }
+  }
+
+private:
+  bool m_json{false};
+};
+
+/// \brief Reporter policy that prints only the tests that fail, the errors
+/// and the exceptions, for programs where the output of the tester would be
+/// in the way
+struct quiet_reporter {
+  void configure(const program::alg::options &) {}
+
+  void describe(std::string_view, std::string_view) {}
+
+  void describe(std::string_view, std::string (*)()) {}
+
+  template <typename t_described> void begin(std::string_view) {}
+
+  void begin(std::string_view, std::string_view) {}
+
+  void begin(std::string_view, std::string (*)()) {}
+
+  void end(std::string_view) {}
+
+  void assertions(std::string_view, std::uint64_t, std::uint64_t) {}
+
+  void result(std::string_view p_name, bool p_success) {
+    if (!p_success) {
+      std::cout << p_name << " FAIL" << std::endl;
+    }
+  }
+
+  void compile_time_pass(std::string_view) {}
+
+  void error(std::string_view p_name, const char *p_what) {
+    std::cout << "ERROR for " << p_name << " '" << p_what << "'" << std::endl;
+  }
+
+  void exception(const char *p_what) {
+    std::cout << "EXCEPTION '" << p_what << "'" << std::endl;
+  }
+
+  void bench(std::string_view, const std::vector<internal::bench_result> &,
+             const std::string &) {}
+
+  void family(std::string_view,
+              const std::vector<internal::bench_result> &) {}
+
+  void load(std::string_view, double, std::chrono::milliseconds,
+            const std::vector<internal::load_point> &) {}
+
+  void tune(std::string_view, internal::tune_strategy, std::size_t,
+            const std::vector<internal::tune_trial> &, std::size_t,
+            const std::string &) {}
+};
+
+/// \brief Timer policy that reads the time stamp counter
+struct tsc_timer {
+  static std::uint64_t now() { return internal::tsc(); }
+
+  static double ticks_per_ns() { return internal::tsc_ticks_per_ns(); }
+};
+
+/// \brief Timer policy that reads 'std::chrono::steady_clock', for machines
+/// where the time stamp counter is not invariant
+struct steady_timer {
+  static std::uint64_t now() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+
+  static constexpr double ticks_per_ns() { return 1.0; }
+};
+
+/// \brief Instrumentation policy that reports, after each test, how its wall
+/// time was spent, the I/O it did and the locks it used, and that implements
+/// '--leak-check', '--heap-profile', '--tlb-counters' and '--result-log'
+struct full_instrumentation {
+  /// \brief Informs that benchmarks can count hardware events
+  static constexpr bool enabled{true};
+
+  void configure(const program::alg::options &p_options) {
+    m_leak_check = p_options.get_bool_param("leak-check");
+    if (m_leak_check) {
+      std::optional<program::alg::options::value> _maybe_sample =
+          p_options.get_single_param("leak-sample");
+      if (_maybe_sample) {
+        m_leak_sample = std::stoul(*_maybe_sample);
+      }
+      if (!internal::alloc_hooks::installed()) {
+        std::cerr << "'--leak-check' ignored, because "
+                     "'tenacitas.lib.test/alg/hook_allocator.h' was not "
+                     "included in the test program"
+                  << std::endl;
+        m_leak_check = false;
+      }
+    }
+
+    m_heap_profile = p_options.get_bool_param("heap-profile");
+    if (m_heap_profile) {
+      std::optional<program::alg::options::value> _maybe_sample =
+          p_options.get_single_param("heap-sample");
+      if (_maybe_sample) {
+        m_heap_sample = std::stoul(*_maybe_sample);
+      }
+      std::optional<program::alg::options::value> _maybe_top =
+          p_options.get_single_param("heap-top");
+      if (_maybe_top) {
+        m_heap_top = std::stoul(*_maybe_top);
+      }
+      if (!internal::alloc_hooks::installed()) {
+        std::cerr << "'--heap-profile' ignored, because "
+                     "'tenacitas.lib.test/alg/hook_allocator.h' was not "
+                     "included in the test program"
+                  << std::endl;
+        m_heap_profile = false;
+      }
+    }
+
+    m_tlb_counters = p_options.get_bool_param("tlb-counters");
+
+    std::optional<program::alg::options::value> _maybe_log =
+        p_options.get_single_param("result-log");
+    if (_maybe_log) {
+      m_result_log.create(*_maybe_log, m_result_log_capacity);
+    }
+  }
+
+  /// \brief A test, or benchmark, starts
+  void begin(std::string_view p_name) { m_result_log.begin(p_name); }
+
+  /// \brief The test, or benchmark, started by \p begin finished
+  void end(internal::result_status p_status) { m_result_log.end(p_status); }
+
+  /// \brief Called right before the test object is created
+  void before_test() {
+    m_sched_before.take();
+    m_io_before.take();
+    if (m_leak_check) {
+      m_alloc_before = internal::alloc_hooks::start_leak_check(m_leak_sample);
+    }
+    if (m_heap_profile) {
+      internal::heap_profile::start(m_heap_sample);
+    }
+    internal::lock_profile::reset();
+  }
+
+  /// \brief Called right after the test object is destroyed
+  ///
+  /// \return \p p_result, or \p false if the test exceeded an I/O budget or
+  /// leaked
+  template <typename t_test_class>
+  bool after_test(std::string_view p_test_name, bool p_result) {
+    return after_test(p_test_name, p_result,
+                      internal::io_budgets<t_test_class>());
+  }
+
+  /// \param p_budgets for the counters of '/proc/self/io'
+  bool after_test(std::string_view p_test_name, bool p_result,
+                  const internal::io_budget &p_budgets) {
+    m_io_after.take();
+    m_sched_after.take();
+    internal::print_sched(std::cerr, p_test_name, m_sched_before,
+                          m_sched_after, internal::current_tid());
+    p_result = internal::print_io(std::cerr, p_test_name, m_io_before,
+                                  m_io_after, p_budgets) &&
+               p_result;
+
+    internal::lock_profile::flush();
+    print_lock_profile(p_test_name);
+
+    if (m_heap_profile) {
+      internal::heap_profile::stop();
+    }
+    if (m_leak_check) {
+      internal::alloc_hooks::stop_leak_check();
+      p_result = no_leaks(p_test_name) && p_result;
+    }
+    if (m_heap_profile) {
+      print_heap_profile(p_test_name);
+    }
+    return p_result;
+  }
+
+  /// \brief Called if the test raised an exception
+  void abort_test() {
+    internal::heap_profile::stop();
+    internal::alloc_hooks::stop_leak_check();
+  }
+
+  /// \brief Counters of the events of each iteration of a benchmark, or
+  /// \p nullptr if '--tlb-counters' was not passed
+  std::unique_ptr<internal::perf_counters> bench_counters() const {
+    if (!m_tlb_counters) {
+      return nullptr;
+    }
+    return std::make_unique<internal::perf_counters>(internal::tlb_events());
+  }
+
+private:
+  /// \brief Compares the live allocations with the ones before the test, and
+  /// prints the size and call stack of the sampled allocations that were not
+  /// released
+  ///
+  /// \return \p true if no allocation made by the test is still alive
+  bool no_leaks(std::string_view p_test_name) {
+    using namespace std;
+    const internal::alloc_snapshot _after{internal::alloc_hooks::snapshot()};
+    const int64_t _count{_after.count - m_alloc_before.count};
+    if (_count <= 0) {
+      return true;
+    }
+
+    cerr << "LEAK for " << p_test_name << ": " << _count
+         << " allocation(s), " << (_after.bytes - m_alloc_before.bytes)
+         << " byte(s) not released\n";
+
+    std::size_t _sampled{0};
+    internal::alloc_hooks::leaks().for_each(
+        [&](const internal::leak_entry &p_leak) {
+          if (++_sampled <= m_max_leaks_printed) {
+            cerr << "  " << p_leak.size << " byte(s) allocated at\n";
+            internal::print_stack(cerr, p_leak.stack, "    ");
+          }
+        });
+    if (_sampled > m_max_leaks_printed) {
+      cerr << "  ... " << (_sampled - m_max_leaks_printed)
+           << " more sampled leak(s)\n";
+    }
+    if (internal::alloc_hooks::leaks().dropped() != 0) {
+      cerr << "  " << internal::alloc_hooks::leaks().dropped()
+           << " allocation(s) not sampled because the table was full\n";
+    }
+    cerr << flush;
+    return false;
+  }
+
+  /// \brief Prints the allocation sites that allocated more bytes, and more
+  /// times, during the last test
+  void print_heap_profile(std::string_view p_test_name) {
+    using namespace std;
+    vector<const internal::heap_site *> _by_bytes;
+    vector<const internal::heap_site *> _by_count;
+    internal::heap_profile::top(m_heap_top, _by_bytes, _by_count);
+
+    uint64_t _bytes{0};
+    uint64_t _count{0};
+    internal::heap_profile::totals(_bytes, _count);
+
+    cerr << "HEAP PROFILE for " << p_test_name << ": ~" << _bytes
+         << " byte(s) in ~" << _count << " allocation(s)\n";
+
+    auto _print = [](const char *p_title,
+                     const vector<const internal::heap_site *> &p_sites) {
+      cerr << "  top " << p_sites.size() << " by " << p_title << '\n';
+      for (const internal::heap_site *_site : p_sites) {
+        cerr << "    ~" << _site->bytes.load() << " byte(s) in ~"
+             << _site->count.load() << " allocation(s), "
+             << _site->samples.load() << " sample(s), at\n";
+        internal::print_stack(cerr, _site->stack, "      ");
+      }
+    };
+    _print("bytes", _by_bytes);
+    _print("count", _by_count);
+
+    if (internal::heap_profile::dropped() != 0) {
+      cerr << "  " << internal::heap_profile::dropped()
+           << " sample(s) lost because the table was full\n";
+    }
+    cerr << flush;
+  }
+
+  /// \brief Prints the acquisitions, waits and hold times of the locks of
+  /// type tenacitas::lib::test::alg::profiled_mutex used in the last test
+  void print_lock_profile(std::string_view p_test_name) {
+    using namespace std;
+    bool _header{false};
+    const double _ticks_per_ns{internal::tsc_ticks_per_ns()};
+    auto _ns = [&](uint64_t p_ticks) {
+      return static_cast<uint64_t>(static_cast<double>(p_ticks) /
+                                   _ticks_per_ns);
+    };
+
+    internal::lock_profile::for_each([&](const internal::lock_site &p_site) {
+      if (!_header) {
+        cerr << "LOCKS for " << p_test_name << '\n'
+             << "  " << left << setw(16) << "lock" << right << setw(12)
+             << "acquired" << setw(12) << "contended" << setw(16)
+             << "wait total ns" << setw(12) << "wait p50" << setw(12)
+             << "wait p99" << setw(12) << "wait max" << setw(16)
+             << "hold total ns" << setw(12) << "hold max" << '\n';
+        _header = true;
+      }
+      cerr << "  " << left << setw(16) << p_site.name << right << setw(12)
+           << p_site.acquisitions.load() << setw(12) << p_site.contended.load()
+           << setw(16) << _ns(p_site.wait_ticks.load()) << setw(12)
+           << _ns(p_site.wait_percentile(0.50)) << setw(12)
+           << _ns(p_site.wait_percentile(0.99)) << setw(12)
+           << _ns(p_site.max_wait_ticks.load()) << setw(16)
+           << _ns(p_site.hold_ticks.load()) << setw(12)
+           << _ns(p_site.max_hold_ticks.load()) << '\n';
+    });
+    cerr << flush;
+  }
+
+private:
+  /// \brief Checks if the tests release all the memory they allocate
+  bool m_leak_check{false};
+
+  /// \brief One in every \p m_leak_sample allocations has its call stack
+  /// recorded during a leak check
+  std::size_t m_leak_sample{1};
+
+  /// \brief Prints the allocation sites of each test
+  bool m_heap_profile{false};
+
+  /// \brief Average number of bytes between two sampled allocations
+  std::size_t m_heap_sample{512 * 1024};
+
+  /// \brief Number of allocation sites printed for each test
+  std::size_t m_heap_top{10};
+
+  /// \brief TLB misses and page faults are counted in benchmarks
+  bool m_tlb_counters{false};
+
+  /// \brief Results of the tests and benchmarks, that survive a crash
+  internal::result_log m_result_log;
+
+  internal::sched_snapshot m_sched_before;
+  internal::sched_snapshot m_sched_after;
+  internal::io_snapshot m_io_before;
+  internal::io_snapshot m_io_after;
+  internal::alloc_snapshot m_alloc_before;
+
+  /// \brief Maximum number of results in \p m_result_log
+  static constexpr std::size_t m_result_log_capacity{4096};
+
+  /// \brief Maximum number of leaked allocations printed per test
+  static constexpr std::size_t m_max_leaks_printed{10};
+};
+
+/// \brief Instrumentation policy that measures nothing
+struct no_instrumentation {
+  static constexpr bool enabled{false};
+
+  void configure(const program::alg::options &) {}
+
+  void begin(std::string_view) {}
+
+  void end(internal::result_status) {}
+
+  void before_test() {}
+
+  template <typename t_test_class>
+  bool after_test(std::string_view, bool p_result) {
+    return p_result;
+  }
+
+  bool after_test(std::string_view, bool p_result,
+                  const internal::io_budget &) {
+    return p_result;
+  }
+
+  void abort_test() {}
+};
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
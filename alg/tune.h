@@ -0,0 +1,174 @@
+#ifndef TENACITAS_LIB_TEST_ALG_TUNE_H
+#define TENACITAS_LIB_TEST_ALG_TUNE_H
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas - rodrigo.canellas at gmail.com
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tenacitas::lib::test::alg {
+
+/// \brief Parameter of a benchmark whose best value is searched by tester
+///
+/// \details An integer parameter has a list of values; a choice parameter,
+/// usually an enum, has a list of labels, and its value is the index of the
+/// label. The labels are written verbatim in the generated header, so they
+/// must be C++ expressions, like "layout::soa".
+struct tune_param {
+  /// \brief Integer parameter that can assume \p p_values
+  ///
+  /// \throw std::invalid_argument if \p p_values is empty
+  static tune_param list(std::string &&p_name,
+                         std::vector<std::int64_t> &&p_values) {
+    if (p_values.empty()) {
+      throw std::invalid_argument("tune parameter '" + p_name +
+                                  "' has no values");
+    }
+    tune_param _param;
+    _param.name = std::move(p_name);
+    _param.values = std::move(p_values);
+    return _param;
+  }
+
+  /// \brief Integer parameter from \p p_first to \p p_last, inclusive,
+  /// incremented by \p p_step
+  ///
+  /// \throw std::invalid_argument if \p p_step is not positive, or if
+  /// \p p_first is greater than \p p_last
+  static tune_param range(std::string &&p_name, std::int64_t p_first,
+                          std::int64_t p_last, std::int64_t p_step = 1) {
+    if ((p_step <= 0) || (p_first > p_last)) {
+      throw std::invalid_argument("invalid range for tune parameter '" +
+                                  p_name + "'");
+    }
+    std::vector<std::int64_t> _values;
+    // stops before the step that would pass 'p_last', which could overflow;
+    // the difference is unsigned, as it may not fit in 'std::int64_t'
+    for (std::int64_t _value = p_first;; _value += p_step) {
+      _values.push_back(_value);
+      if (static_cast<std::uint64_t>(p_last) -
+              static_cast<std::uint64_t>(_value) <
+          static_cast<std::uint64_t>(p_step)) {
+        break;
+      }
+    }
+    return list(std::move(p_name), std::move(_values));
+  }
+
+  /// \brief Integer parameter with the powers of two from \p p_first to
+  /// \p p_last, inclusive
+  ///
+  /// \throw std::invalid_argument if \p p_first is not positive, or if
+  /// \p p_first is greater than \p p_last
+  static tune_param powers_of_two(std::string &&p_name, std::int64_t p_first,
+                                  std::int64_t p_last) {
+    if ((p_first <= 0) || (p_first > p_last)) {
+      throw std::invalid_argument("invalid range for tune parameter '" +
+                                  p_name + "'");
+    }
+    std::vector<std::int64_t> _values;
+    // stops before the product that would pass 'p_last', which could overflow
+    for (std::int64_t _value = p_first;; _value *= 2) {
+      _values.push_back(_value);
+      if (_value > p_last / 2) {
+        break;
+      }
+    }
+    return list(std::move(p_name), std::move(_values));
+  }
+
+  /// \brief Choice parameter, whose value is the index of one of \p p_labels
+  ///
+  /// \throw std::invalid_argument if \p p_labels is empty
+  static tune_param choices(std::string &&p_name,
+                            std::vector<std::string> &&p_labels) {
+    if (p_labels.empty()) {
+      throw std::invalid_argument("tune parameter '" + p_name +
+                                  "' has no choices");
+    }
+    tune_param _param;
+    _param.name = std::move(p_name);
+    for (std::size_t _i = 0; _i < p_labels.size(); ++_i) {
+      _param.values.push_back(static_cast<std::int64_t>(_i));
+    }
+    _param.labels = std::move(p_labels);
+    return _param;
+  }
+
+  /// \brief Informs if the parameter is a choice among labels
+  bool is_choice() const { return !labels.empty(); }
+
+  /// \brief Text of the value at \p p_idx, as written in the generated header
+  std::string text(std::size_t p_idx) const {
+    return is_choice() ? labels[p_idx] : std::to_string(values[p_idx]);
+  }
+
+  /// \brief Identifier of the parameter in the generated header
+  std::string name;
+  std::vector<std::int64_t> values;
+  std::vector<std::string> labels;
+};
+
+/// \brief Parameters of a benchmark, returned by
+///
+/// \code
+/// static test::alg::tune_space tune_space()
+/// \endcode
+using tune_space = std::vector<tune_param>;
+
+/// \brief One value for each parameter of a \p tune_space
+struct tune_config {
+  /// \param p_space must outlive the configuration
+  ///
+  /// \param p_indexes index of the value of each parameter in \p p_space
+  tune_config(const tune_space &p_space, std::vector<std::size_t> &&p_indexes)
+      : m_space(&p_space), m_indexes(std::move(p_indexes)) {}
+
+  /// \brief Value of a parameter
+  ///
+  /// \throw std::out_of_range if there is no parameter named \p p_name
+  std::int64_t value(std::string_view p_name) const {
+    for (std::size_t _i = 0; _i < m_indexes.size(); ++_i) {
+      const tune_param &_param{(*m_space)[_i]};
+      if (_param.name == p_name) {
+        return _param.values[m_indexes[_i]];
+      }
+    }
+    throw std::out_of_range("no tune parameter named '" +
+                            std::string{p_name} + "'");
+  }
+
+  const tune_space &space() const { return *m_space; }
+
+  const std::vector<std::size_t> &indexes() const { return m_indexes; }
+
+  bool operator==(const tune_config &p_config) const {
+    return m_indexes == p_config.m_indexes;
+  }
+
+  friend std::ostream &operator<<(std::ostream &p_out,
+                                  const tune_config &p_config) {
+    for (std::size_t _i = 0; _i < p_config.m_indexes.size(); ++_i) {
+      p_out << (_i == 0 ? "" : " ") << (*p_config.m_space)[_i].name << '='
+            << (*p_config.m_space)[_i].text(p_config.m_indexes[_i]);
+    }
+    return p_out;
+  }
+
+private:
+  const tune_space *m_space;
+  std::vector<std::size_t> m_indexes;
+};
+
+} // namespace tenacitas::lib::test::alg
+
+#endif
@@ -1,10 +1,48 @@
 TEMPLATE = subdirs
 
-SUBDIRS = tst
+SUBDIRS = tst overhead
+
+overhead.file = tst/overhead.pro
 
 include (../../../tenacitas.bld/qtcreator/common.pri)
 
-HEADERS=$$BASE_DIR/tenacitas.lib.test/alg/tester.h
+HEADERS=$$BASE_DIR/tenacitas.lib.test/alg/tester.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/tester_policies.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/bench_state.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/page_buffer.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/hook_allocator.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/profiled_mutex.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/random.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/tune.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/registry.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/test_main.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/tester_modes.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/death_test.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/check.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/compare_arrays.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/diff_sequences.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/dataset_cache.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/ab_driver.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/alloc_hooks.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/bench_report.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/bench_stats.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/cache.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/dataset_directory.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/heap_profile.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/io_budget.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/io_stats.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/latency_histogram.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/load_generator.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/lock_profile.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/mode_hooks.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/perf_counters.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/result_log.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/sched_stats.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/stack_trace.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/tsc.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/tuner.h \
+        $$BASE_DIR/tenacitas.lib.test/alg/internal/type_name.h
 
 DISTFILES += \
-    $$BASE_DIR/tenacitas.lib.test/README.md
+    $$BASE_DIR/tenacitas.lib.test/README.md \
+    $$BASE_DIR/tenacitas.lib.test/tst/compile_time.sh
@@ -0,0 +1,5 @@
+QT -= core
+TEMPLATE = app
+TARGET=tenacitas.lib.test.overhead
+include (../../../../tenacitas.bld/qtcreator/common.pri)
+SOURCES=$$BASE_DIR/tenacitas.lib.test/tst/overhead.cpp
@@ -3,4 +3,5 @@ TEMPLATE = app
 CONFIG+=test
 TARGET=tenacitas.lib.test.tst
 include (../../../../tenacitas.bld/qtcreator/common.pri)
-SOURCES=$$BASE_DIR/tenacitas.lib.test/tst/main.cpp
+SOURCES=$$BASE_DIR/tenacitas.lib.test/tst/main.cpp \
+        $$BASE_DIR/tenacitas.lib.test/tst/registered.cpp
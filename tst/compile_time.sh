@@ -0,0 +1,90 @@
+#!/bin/sh
+
+# Compares the time to compile a test translation unit that includes
+# tenacitas.lib.test/alg/tester.h with one that includes only
+# tenacitas.lib.test/alg/registry.h, both with the same tests, and with the
+# same translation unit compiled with the tester.h of a baseline revision
+#
+# usage: compile_time.sh [<base-dir>] [<repetitions>] [<baseline-revision>]
+#
+# <base-dir> is where the tenacitas.lib.* repositories are cloned, by default
+# the parent of this repository; <repetitions> is how many times each
+# translation unit is compiled, by default 10; <baseline-revision> is the
+# revision of this repository whose tester.h is the baseline, by default the
+# first one. 'CXX' and 'CXXFLAGS' choose the compiler and its flags
+
+set -e
+
+BASE_DIR=${1:-$(cd "$(dirname "$0")/../.." && pwd)}
+REPETITIONS=${2:-10}
+REPO_DIR=$(cd "$(dirname "$0")/.." && pwd)
+BASELINE=${3:-$(git -C "$REPO_DIR" rev-list --max-parents=0 HEAD)}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++17 -O2}
+TESTS=20
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# $1 is the file, $2 the include, $3 what is written after each test
+generate() {
+  {
+    echo "#include <string_view>"
+    echo "#include <vector>"
+    echo "#include <$2>"
+    echo "using namespace tenacitas::lib;"
+    _i=0
+    while [ $_i -lt $TESTS ]; do
+      echo "struct test_$_i {"
+      echo "  bool operator()(const program::alg::options &) {"
+      echo "    std::vector<int> _v($_i + 1, 1);"
+      echo "    return _v.size() == $_i + 1;"
+      echo "  }"
+      echo "  static constexpr std::string_view desc() { return \"test $_i\"; }"
+      echo "};"
+      echo "$3" | sed "s/@/test_$_i/g"
+      _i=$((_i + 1))
+    done
+  } > "$1"
+}
+
+generate "$WORK_DIR/with_tester.cpp" tenacitas.lib.test/alg/tester.h \
+  "void run_@(test::alg::tester<> &p_tester) { run_test(p_tester, @); }"
+generate "$WORK_DIR/with_registry.cpp" tenacitas.lib.test/alg/registry.h \
+  "register_test(@);"
+
+# the headers of the baseline revision shadow the ones of this repository
+mkdir -p "$WORK_DIR/baseline/tenacitas.lib.test"
+git -C "$REPO_DIR" archive "$BASELINE" alg |
+  tar -x -C "$WORK_DIR/baseline/tenacitas.lib.test"
+
+now() { date +%s.%N; }
+
+# prints the average seconds to compile $1, with the includes in $2 searched
+# before <base-dir>
+measure() {
+  _start=$(now)
+  _i=0
+  while [ $_i -lt "$REPETITIONS" ]; do
+    $CXX $CXXFLAGS $2 -I"$BASE_DIR" -c "$1" -o "$WORK_DIR/out.o"
+    _i=$((_i + 1))
+  done
+  _end=$(now)
+  echo "$_start $_end $REPETITIONS" | awk '{ printf "%.3f", ($2 - $1) / $3 }'
+}
+
+BASELINE_TESTER=$(measure "$WORK_DIR/with_tester.cpp" \
+  "-I$WORK_DIR/baseline")
+TESTER=$(measure "$WORK_DIR/with_tester.cpp")
+REGISTRY=$(measure "$WORK_DIR/with_registry.cpp")
+
+echo "compile time of a translation unit with $TESTS tests, $CXX $CXXFLAGS"
+printf "  %-32s %s s\n" \
+  "including tester.h of $(git -C "$REPO_DIR" rev-parse --short "$BASELINE")" \
+  "$BASELINE_TESTER" \
+  "including tester.h" "$TESTER" \
+  "including registry.h" "$REGISTRY"
+echo "$TESTER $BASELINE_TESTER" |
+  awk '{ printf "  tester.h costs %.3f s more than the baseline (%.1f times)\n", $1 - $2, $1 / $2 }'
+echo "$TESTER $REGISTRY" |
+  awk '{ printf "  saved per translation unit %.3f s (%.0f%%)\n", $1 - $2, 100 * ($1 - $2) / $1 }'
@@ -5,11 +5,43 @@
 
 /// \author Rodrigo Canellas rodrigo.canellas@gmail.com
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <cstring>
 #include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <tenacitas.lib.program/alg/options.h>
+#include <tenacitas.lib.test/alg/bench_state.h>
+#include <tenacitas.lib.test/alg/check.h>
+#include <tenacitas.lib.test/alg/compare_arrays.h>
+#include <tenacitas.lib.test/alg/dataset_cache.h>
+#include <tenacitas.lib.test/alg/death_test.h>
+#include <tenacitas.lib.test/alg/diff_sequences.h>
+#include <tenacitas.lib.test/alg/hook_allocator.h>
+#include <tenacitas.lib.test/alg/page_buffer.h>
+#include <tenacitas.lib.test/alg/profiled_mutex.h>
+#include <tenacitas.lib.test/alg/random.h>
 #include <tenacitas.lib.test/alg/tester.h>
+#include <tenacitas.lib.test/alg/tester_modes.h>
 
 using namespace tenacitas::lib;
 
@@ -37,12 +69,760 @@ struct test_error {
   static std::string desc() { return "an eror test"; }
 };
 
+struct test_crash {
+  bool operator()(const program::alg::options &p_options) {
+    if (p_options.get_bool_param("crash")) {
+      volatile int *_null{nullptr};
+      *_null = 0;
+    }
+    return true;
+  }
+  static std::string desc() {
+    return "crashes if '--crash' is passed, recovered with '--result-log'";
+  }
+};
+
+struct test_no_leak {
+  bool operator()(const program::alg::options &) {
+    std::vector<int> _v(1000, 5);
+    auto _p = std::make_unique<std::string>("released at the end of the test");
+    return _v.size() == 1000;
+  }
+  static std::string desc() {
+    return "allocates and releases memory, passes with '--leak-check'";
+  }
+};
+
+struct test_leak {
+  bool operator()(const program::alg::options &) {
+    m_leaked = new std::vector<int>(100, 1);
+    return true;
+  }
+  static std::string desc() {
+    return "does not release memory, fails with '--leak-check'";
+  }
+
+  static inline std::vector<int> *m_leaked{nullptr};
+};
+
+struct test_heap_profile {
+  bool operator()(const program::alg::options &) {
+    std::vector<std::string> _strings;
+    for (std::size_t _i = 0; _i < 100000; ++_i) {
+      _strings.push_back(std::string(100, 'a'));
+    }
+    return _strings.size() == 100000;
+  }
+  static std::string desc() {
+    return "allocates many strings, shown with '--heap-profile'";
+  }
+};
+
+struct test_blocked {
+  bool operator()(const program::alg::options &) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    long _sum{0};
+    for (long _i = 0; _i < 10000000; ++_i) {
+      _sum += _i % 7;
+    }
+    return _sum > 0;
+  }
+  static std::string desc() {
+    return "sleeps 20 ms and computes, shown as blocked and cpu time";
+  }
+};
+
+template <std::size_t t_bytes> struct test_io_budget {
+  bool operator()(const program::alg::options &p_options) {
+    // exceeding the budget makes the test fail, so it is done only if asked
+    const std::size_t _bytes{
+        ((t_bytes > max_wchar) && !p_options.get_bool_param("io-over-budget"))
+            ? max_wchar / 4
+            : t_bytes};
+    const std::vector<char> _data(_bytes, 'x');
+    std::FILE *_file{std::tmpfile()};
+    if (_file == nullptr) {
+      return false;
+    }
+    const std::size_t _written{std::fwrite(_data.data(), 1, _data.size(), _file)};
+    std::fclose(_file);
+    return _written == _bytes;
+  }
+  static std::string desc() {
+    if constexpr (t_bytes > max_wchar) {
+      return "writes " + std::to_string(t_bytes) +
+             " bytes to a temporary file, with 'max_wchar' of 64K, if "
+             "'--io-over-budget' is passed";
+    } else {
+      return "writes " + std::to_string(t_bytes) +
+             " bytes to a temporary file, with 'max_wchar' of 64K";
+    }
+  }
+
+  static constexpr std::size_t max_wchar{64 * 1024};
+};
+
+using test_io_within_budget = test_io_budget<16 * 1024>;
+using test_io_over_budget = test_io_budget<128 * 1024>;
+
+struct test_lock_contention {
+  bool operator()(const program::alg::options &) {
+    test::alg::profiled_mutex _queue_mutex{"queue"};
+    test::alg::profiled_shared_mutex _config_mutex{"config"};
+    std::vector<std::thread> _threads;
+    for (int _i = 0; _i < 4; ++_i) {
+      _threads.emplace_back([&]() {
+        for (int _j = 0; _j < 1000; ++_j) {
+          {
+            std::shared_lock<test::alg::profiled_shared_mutex> _lock{
+                _config_mutex};
+            m_sum += m_config;
+          }
+          std::lock_guard<test::alg::profiled_mutex> _lock{_queue_mutex};
+          m_queue.push_back(_j);
+        }
+      });
+    }
+    for (std::thread &_thread : _threads) {
+      _thread.join();
+    }
+    return m_queue.size() == 4000;
+  }
+  static std::string desc() {
+    return "pushes to a queue from 4 threads, reporting the lock contention";
+  }
+
+  std::vector<int> m_queue;
+  std::atomic<long> m_sum{0};
+  int m_config{1};
+};
+
+struct test_death_abort {
+  bool operator()(const program::alg::options &) {
+    return test::alg::expect_death(
+        []() {
+          std::cerr << "queue invariant broken: size " << -1 << std::endl;
+          std::abort();
+        },
+        SIGABRT, "invariant broken: size -[0-9]+");
+  }
+  static std::string desc() {
+    return "checks that a function aborts, writing a message to stderr";
+  }
+};
+
+struct test_death_survives {
+  bool operator()(const program::alg::options &) {
+    std::cerr << "a function that does not die must fail the check:"
+              << std::endl;
+    return !test::alg::expect_death([]() {}, "");
+  }
+  static std::string desc() {
+    return "checks that 'expect_death' fails if the function returns";
+  }
+};
+
+struct test_death_hangs {
+  bool operator()(const program::alg::options &) {
+    std::cerr << "a function that closes stderr and hangs must fail the "
+                 "check when the timeout expires:"
+              << std::endl;
+    const auto _start{std::chrono::steady_clock::now()};
+    const bool _died{test::alg::expect_death(
+        []() {
+          ::close(STDERR_FILENO);
+          for (;;) {
+            ::pause();
+          }
+        },
+        "", std::chrono::milliseconds{300})};
+    check_that(!_died);
+    check_that(std::chrono::steady_clock::now() - _start <
+               std::chrono::seconds{5});
+    return true;
+  }
+  static std::string desc() {
+    return "checks that 'expect_death' kills a function that closes stderr "
+           "and does not end";
+  }
+};
+
+struct test_checks {
+  bool operator()(const program::alg::options &p_options) {
+    std::vector<int> _values{3, 1, 2};
+    std::sort(_values.begin(), _values.end());
+    check_that(_values.size() == 3U);
+    check_that(_values.front() == 1);
+    check_that(std::is_sorted(_values.begin(), _values.end()));
+    if (p_options.get_bool_param("check-fail")) {
+      expect_that(_values.back() > 3);
+      expect_that(std::string{"abc"} == "abd");
+    }
+    return true;
+  }
+  static std::string desc() {
+    return "checks a sorted vector; two checks fail if '--check-fail' is "
+           "passed, and the test continues";
+  }
+};
+
+template <typename t_value> struct test_compare_arrays {
+  bool operator()(const program::alg::options &) {
+    std::vector<t_value> _expected(10007);
+    std::mt19937 _engine{7};
+    std::uniform_real_distribution<t_value> _distribution{0, 1};
+    for (t_value &_value : _expected) {
+      _value = _distribution(_engine);
+    }
+    std::vector<t_value> _actual{_expected};
+    _actual[5] = std::nextafter(_actual[5], t_value{2});
+    _actual[700] += 1;
+    _actual[9000] = std::numeric_limits<t_value>::quiet_NaN();
+    _expected[9001] = std::numeric_limits<t_value>::quiet_NaN();
+    _actual[9001] = std::numeric_limits<t_value>::quiet_NaN();
+
+    using test::alg::internal::simd_level;
+    for (simd_level _level : {simd_level::scalar, simd_level::sse2,
+                              test::alg::internal::detected_simd_level()}) {
+      const auto _exact{compare(_level, _expected, _actual,
+                                test::alg::tolerance::exact())};
+      check_that(_exact.mismatches == 3U);
+      check_that(_exact.first.size() == 2U);
+      check_that(_exact.first[0].index == 5U);
+      check_that(_exact.first[1].index == 700U);
+
+      check_that(compare(_level, _expected, _actual,
+                         test::alg::tolerance::ulp(1))
+                     .mismatches == 2U);
+      check_that(compare(_level, _expected, _actual,
+                         test::alg::tolerance::relative(1e-5))
+                     .mismatches == 2U);
+      check_that(compare(_level, _expected, _actual,
+                         test::alg::tolerance::absolute(1e-3))
+                     .mismatches == 2U);
+    }
+    _actual.pop_back();
+    check_that(!test::alg::compare_arrays(_expected, _actual));
+    return true;
+  }
+
+  static std::string desc() {
+    return "compares arrays with each tolerance, and each instruction set";
+  }
+
+private:
+  static test::alg::array_comparison<t_value>
+  compare(test::alg::internal::simd_level p_level,
+          const std::vector<t_value> &p_expected,
+          const std::vector<t_value> &p_actual,
+          test::alg::tolerance p_tolerance) {
+    return test::alg::internal::compare_arrays(
+        p_level, p_expected.data(), p_expected.size(), p_actual.data(),
+        p_actual.size(), p_tolerance, 2);
+  }
+};
+
+using test_compare_arrays_float = test_compare_arrays<float>;
+using test_compare_arrays_double = test_compare_arrays<double>;
+
+struct test_diff_sequences {
+  bool operator()(const program::alg::options &) {
+    std::vector<int> _expected(1000000);
+    std::iota(_expected.begin(), _expected.end(), 0);
+    std::vector<int> _actual{_expected};
+    _actual.erase(_actual.begin() + 1000);
+    _actual[500000] = -1;
+    _actual.insert(_actual.begin() + 900000, 7);
+
+    const test::alg::sequence_diff<std::vector<int>> _diff{
+        test::alg::diff_sequences(_expected, _actual)};
+    check_that(_diff.removed == 2U);
+    check_that(_diff.inserted == 2U);
+    check_that(_diff.minimal);
+
+    std::ostringstream _stream;
+    _stream << _diff;
+    const std::string _printed{_stream.str()};
+    check_that(std::count(_printed.begin(), _printed.end(), '\n') == 25);
+    check_that(_printed.find("\n- [1000] 1000\n") != std::string::npos);
+    check_that(_printed.find("\n+ [500000] -1\n") != std::string::npos);
+    check_that(_printed.find("\n+ [900000] 7\n") != std::string::npos);
+    return true;
+  }
+
+  static std::string desc() {
+    return "prints only the differences of two vectors with 1M integers";
+  }
+};
+
+struct test_random {
+  bool operator()(const program::alg::options &) {
+    check_that(test::alg::test_seed() ==
+               test::alg::internal::seed_of("test_random"));
+    check_that(test::alg::test_seed() !=
+               test::alg::internal::seed_of("test_random_other"));
+
+    test::alg::wyrand _engine;
+    test::alg::wyrand _same{test::alg::test_seed()};
+    check_that(_engine() == _same());
+
+    std::vector<std::int16_t> _values(100000);
+    test::alg::fill_uniform(_engine, _values.data(), _values.size(),
+                            std::int16_t{-5}, std::int16_t{5});
+    const auto [_min, _max] =
+        std::minmax_element(_values.begin(), _values.end());
+    check_that(*_min == -5);
+    check_that(*_max == 5);
+
+    std::vector<std::int32_t> _full(100000);
+    test::alg::fill_uniform(_engine, _full.data(), _full.size(),
+                            std::numeric_limits<std::int32_t>::min(),
+                            std::numeric_limits<std::int32_t>::max());
+    check_that(std::any_of(_full.begin(), _full.end(),
+                           [](std::int32_t p_value) { return p_value < 0; }));
+    check_that(std::any_of(_full.begin(), _full.end(),
+                           [](std::int32_t p_value) { return p_value > 0; }));
+
+    std::vector<std::uint32_t> _keys(100000);
+    test::alg::xoshiro256pp _xoshiro;
+    test::alg::fill_zipf(_xoshiro, _keys.data(), _keys.size(), 1000, 1.0);
+    const auto _first{std::count(_keys.begin(), _keys.end(), 0U)};
+    const auto _second{std::count(_keys.begin(), _keys.end(), 1U)};
+    check_that(_first > _second * 19 / 10);
+    check_that(_first < _second * 21 / 10);
+    return true;
+  }
+
+  static std::string desc() {
+    return "generates values from the seed of the test, derived from its "
+           "name and '--seed'";
+  }
+};
+
+struct test_dataset_cache {
+  bool operator()(const program::alg::options &) {
+    const std::string _id{"test_dataset_cache-" + std::to_string(getpid())};
+    std::size_t _calls{0};
+    auto _generate{[&_calls](std::uint64_t *p_values, std::size_t p_count,
+                             std::uint64_t p_seed) {
+      ++_calls;
+      test::alg::wyrand _engine{p_seed};
+      _engine.fill(p_values, p_count);
+    }};
+
+    test::alg::dataset<std::uint64_t> _first{
+        test::alg::cached_dataset<std::uint64_t>(_id, "uniform", 1000000,
+                                                 _generate)};
+    test::alg::dataset<std::uint64_t> _second{
+        test::alg::cached_dataset<std::uint64_t>(_id, "uniform", 1000000,
+                                                 _generate)};
+    test::alg::dataset<std::uint64_t> _other{
+        test::alg::cached_dataset<std::uint64_t>(_id, "uniform", 7, 1000,
+                                                 _generate)};
+    const std::string _first_path{_first.path()};
+    const std::string _other_path{_other.path()};
+    std::remove(_first_path.c_str());
+    std::remove((_first_path + ".lock").c_str());
+    std::remove(_other_path.c_str());
+    std::remove((_other_path + ".lock").c_str());
+
+    check_that(_calls == 2U);
+    check_that(_first.generated());
+    check_that(!_second.generated());
+    check_that(_other.generated());
+    check_that(_first_path == _second.path());
+    check_that(_first_path != _other_path);
+    check_that(_second.size() == 1000000U);
+    check_that(_first.data() != _second.data());
+    check_that(std::equal(_first.begin(), _first.end(), _second.begin()));
+
+    test::alg::wyrand _engine{test::alg::internal::seed_of(_id)};
+    check_that(_second[0] == _engine());
+    check_that(_other[0] == test::alg::wyrand{7}());
+
+    const test::alg::dataset<std::uint64_t> _moved{std::move(_other)};
+    check_that(_moved.size() == 1000U);
+    check_that(_other.size() == 0U);
+    check_that(_other.begin() == _other.end());
+    return true;
+  }
+
+  static std::string desc() {
+    return "generates a dataset of 1M integers once, and maps it when it is "
+           "needed again";
+  }
+};
+
+struct bench_map_lookup {
+  bench_map_lookup() {
+    for (int _i = 0; _i < 10000; ++_i) {
+      m_map[_i * 7] = _i;
+    }
+  }
+
+  void operator()(const program::alg::options &) {
+    for (int _i = 0; _i < 100; ++_i) {
+      m_sum += m_map.find((_i * 7919) % 70000)->second;
+    }
+  }
+
+  static std::string desc() {
+    return "looks up keys in a 'std::map', compare '--cold-cache' results";
+  }
+
+  std::map<int, int> m_map;
+  int m_sum{0};
+};
+
+template <test::alg::page_kind t_kind> struct bench_random_access {
+  bench_random_access() : m_buffer(256 * 1024 * 1024, t_kind) {}
+
+  void operator()(const program::alg::options &) {
+    const std::uint64_t *_data{m_buffer.as<std::uint64_t>()};
+    const std::size_t _count{m_buffer.count<std::uint64_t>()};
+    for (std::size_t _i = 0; _i < 1000; ++_i) {
+      m_pos = (m_pos * 6364136223846793005ULL + 1442695040888963407ULL);
+      m_sum += _data[m_pos % _count];
+    }
+  }
+
+  static std::string desc() {
+    return "random reads in 256M, compare '--tlb-counters' for 4K and huge "
+           "pages";
+  }
+
+  test::alg::page_buffer m_buffer;
+  std::uint64_t m_pos{1};
+  std::uint64_t m_sum{0};
+};
+
+using bench_random_access_4k = bench_random_access<test::alg::page_kind::regular>;
+using bench_random_access_2m =
+    bench_random_access<test::alg::page_kind::transparent_huge>;
+
+struct bench_sort_batch {
+  static constexpr std::size_t batch_size{32};
+
+  bench_sort_batch() {
+    for (std::vector<int> &_input : m_inputs) {
+      _input.resize(1000);
+      std::iota(_input.begin(), _input.end(), 0);
+    }
+  }
+
+  void setup(test::alg::bench_state &) {
+    for (std::vector<int> &_input : m_inputs) {
+      std::shuffle(_input.begin(), _input.end(), m_engine);
+    }
+  }
+
+  void operator()(test::alg::bench_state &p_state) {
+    std::vector<int> &_input{m_inputs[p_state.batch_index()]};
+    std::sort(_input.begin(), _input.end());
+  }
+
+  static std::string desc() {
+    return "sorts vectors shuffled in batches, out of the measured region";
+  }
+
+  std::array<std::vector<int>, batch_size> m_inputs;
+  std::mt19937 m_engine{42};
+};
+
+struct bench_sort_pause {
+  bench_sort_pause() : m_input(1000) {
+    std::iota(m_input.begin(), m_input.end(), 0);
+  }
+
+  void operator()(test::alg::bench_state &p_state) {
+    p_state.pause_timing();
+    std::shuffle(m_input.begin(), m_input.end(), m_engine);
+    p_state.resume_timing();
+    std::sort(m_input.begin(), m_input.end());
+  }
+
+  static std::string desc() {
+    return "sorts a vector shuffled while the timing is paused";
+  }
+
+  std::vector<int> m_input;
+  std::mt19937 m_engine{42};
+};
+
+struct bench_copy_throughput {
+  bench_copy_throughput() : m_from(1024 * 1024, 'x'), m_to(1024 * 1024) {}
+
+  void operator()(test::alg::bench_state &p_state) {
+    std::memcpy(m_to.data(), m_from.data(), m_from.size());
+    p_state.add_bytes(m_from.size());
+    p_state.add_items(1);
+    p_state.add_counter("calls", 1, test::alg::counter_rate::per_iteration);
+  }
+
+  static std::string desc() {
+    return "copies 1M per iteration, reporting bytes and items per second";
+  }
+
+  std::vector<char> m_from;
+  std::vector<char> m_to;
+};
+
+template <test::alg::internal::simd_level t_level>
+struct bench_compare_arrays {
+  bench_compare_arrays() : m_expected(64 * 1024) {
+    std::mt19937 _engine{11};
+    std::uniform_real_distribution<float> _distribution{-1, 1};
+    for (float &_value : m_expected) {
+      _value = _distribution(_engine);
+    }
+    m_actual = m_expected;
+    for (std::size_t _i = 0; _i < m_actual.size(); _i += 3) {
+      m_actual[_i] = std::nextafter(m_actual[_i], 2.0f);
+    }
+  }
+
+  void operator()(test::alg::bench_state &p_state) {
+    const test::alg::array_comparison<float> _comparison{
+        test::alg::internal::compare_arrays(
+            t_level, m_expected.data(), m_expected.size(), m_actual.data(),
+            m_actual.size(), test::alg::tolerance::ulp(4), 10)};
+    if (!_comparison) {
+      throw std::runtime_error("arrays do not match");
+    }
+    p_state.add_bytes(2 * m_expected.size() * sizeof(float));
+  }
+
+  static std::string desc() {
+    return "compares 64K floats within 4 ULP, with the instruction set " +
+           std::to_string(static_cast<int>(t_level)) +
+           " (0 = scalar, 1 = SSE2, 2 = AVX2)";
+  }
+
+  std::vector<float> m_expected;
+  std::vector<float> m_actual;
+};
+
+using bench_compare_arrays_scalar =
+    bench_compare_arrays<test::alg::internal::simd_level::scalar>;
+using bench_compare_arrays_sse2 =
+    bench_compare_arrays<test::alg::internal::simd_level::sse2>;
+using bench_compare_arrays_avx2 =
+    bench_compare_arrays<test::alg::internal::simd_level::avx2>;
+
+struct bench_fill_wyrand {
+  void operator()(test::alg::bench_state &p_state) {
+    test::alg::fill_uniform(m_engine, m_values.data(), m_values.size(),
+                            std::uint32_t{0}, std::uint32_t{999});
+    p_state.add_items(m_values.size());
+  }
+
+  static std::string desc() {
+    return "fills 64K integers in [0, 999] with 'test::alg::wyrand'";
+  }
+
+  test::alg::wyrand m_engine;
+  std::vector<std::uint32_t> m_values = std::vector<std::uint32_t>(64 * 1024);
+};
+
+struct bench_fill_mt19937 {
+  void operator()(test::alg::bench_state &p_state) {
+    std::uniform_int_distribution<std::uint32_t> _distribution{0, 999};
+    for (std::uint32_t &_value : m_values) {
+      _value = _distribution(m_engine);
+    }
+    p_state.add_items(m_values.size());
+  }
+
+  static std::string desc() {
+    return "fills 64K integers in [0, 999] with 'std::mt19937' and "
+           "'std::uniform_int_distribution', for comparison";
+  }
+
+  std::mt19937 m_engine{static_cast<std::uint32_t>(test::alg::test_seed())};
+  std::vector<std::uint32_t> m_values = std::vector<std::uint32_t>(64 * 1024);
+};
+
+struct bench_family_lookup {
+  bench_family_lookup() : m_keys(1000) {
+    std::iota(m_keys.begin(), m_keys.end(), 0);
+    std::shuffle(m_keys.begin(), m_keys.end(), std::mt19937{7});
+  }
+
+  template <typename t_impl>
+  void operator()(t_impl &p_impl, test::alg::bench_state &p_state) {
+    if (p_impl.empty()) {
+      p_state.pause_timing();
+      for (int _key : m_keys) {
+        p_impl[_key] = _key;
+      }
+      p_state.resume_timing();
+    }
+    for (int _key : m_keys) {
+      m_sum += p_impl.find(_key)->second;
+    }
+    p_state.add_items(m_keys.size());
+  }
+
+  static std::string desc() {
+    return "compares key lookup in associative containers";
+  }
+
+  std::vector<int> m_keys;
+  long m_sum{0};
+};
+
+enum class sum_kind { plain, accumulate };
+
+struct bench_tune_block_sum {
+  bench_tune_block_sum() : m_values(256 * 1024, 3) {}
+
+  static test::alg::tune_space tune_space() {
+    return {test::alg::tune_param::powers_of_two("block", 64, 16384),
+            test::alg::tune_param::choices(
+                "kind", {"sum_kind::plain", "sum_kind::accumulate"})};
+  }
+
+  void operator()(test::alg::bench_state &p_state) {
+    const std::size_t _block{static_cast<std::size_t>(p_state.param("block"))};
+    const sum_kind _kind{static_cast<sum_kind>(p_state.param("kind"))};
+    for (std::size_t _begin = 0; _begin < m_values.size(); _begin += _block) {
+      const std::size_t _end{std::min(_begin + _block, m_values.size())};
+      if (_kind == sum_kind::plain) {
+        for (std::size_t _i = _begin; _i < _end; ++_i) {
+          m_sum += m_values[_i];
+        }
+      } else {
+        m_sum = std::accumulate(m_values.begin() + _begin,
+                                m_values.begin() + _end, m_sum);
+      }
+    }
+    p_state.add_bytes(m_values.size() * sizeof(int));
+  }
+
+  static std::string desc() {
+    return "sums a vector in blocks, tuning the block size and the loop";
+  }
+
+  std::vector<int> m_values;
+  long m_sum{0};
+};
+
+struct bench_load_handler {
+  bench_load_handler() : m_table(4096) {
+    std::iota(m_table.begin(), m_table.end(), 0);
+  }
+
+  void operator()(test::alg::bench_state &p_state) {
+    const std::size_t _work{p_state.iteration() % 16 == 0 ? 20000u : 2000u};
+    for (std::size_t _i = 0; _i < _work; ++_i) {
+      m_sum += m_table[(_i * 31) % m_table.size()];
+    }
+  }
+
+  static std::string desc() {
+    return "handles requests where one in 16 is 10 times slower";
+  }
+
+  std::vector<int> m_table;
+  long m_sum{0};
+};
+
+/// \brief Number of bits set, as a bit manipulation helper under test
+constexpr int count_bits(std::uint64_t p_value) {
+  int _count{0};
+  for (; p_value != 0; p_value &= p_value - 1) {
+    ++_count;
+  }
+  return _count;
+}
+
+struct test_constexpr_count_bits {
+  static constexpr bool check() {
+    return (count_bits(0) == 0) && (count_bits(1) == 1) &&
+           (count_bits(0xFF00) == 8) && (count_bits(~std::uint64_t{0}) == 64);
+  }
+
+  static std::string desc() {
+    return "counts the bits set in integers, while compiling";
+  }
+};
+
+struct test_trivial {
+  bool operator()(const program::alg::options &) { return true; }
+
+  static constexpr std::string_view desc() { return "does nothing"; }
+};
+
+struct bench_dispatch {
+  void operator()(test::alg::bench_state &p_state) {
+    const std::int64_t _before{
+        test::alg::internal::alloc_hooks::allocations()};
+    run_test(m_tester, test_trivial);
+    m_tester.run_registered();
+    const std::int64_t _allocations{
+        test::alg::internal::alloc_hooks::allocations() - _before};
+    if (_allocations != 0) {
+      throw std::runtime_error("dispatching the tests allocated " +
+                               std::to_string(_allocations) + " times");
+    }
+    p_state.add_counter("allocations", static_cast<double>(_allocations),
+                        test::alg::counter_rate::per_iteration);
+  }
+
+  static std::string desc() {
+    return "executes an empty test, and the registered ones, with a "
+           "'test::alg::lean_tester', which must not allocate";
+  }
+
+  char m_name[9]{"dispatch"};
+  char *m_argv[2]{m_name, nullptr};
+  test::alg::lean_tester m_tester{1, m_argv};
+};
+
 int main(int argc, char **argv) {
   try {
     test::alg::tester _test(argc, argv);
     run_test(_test, test_ok);
     run_test(_test, test_fail);
     run_test(_test, test_error);
+    run_test(_test, test_crash);
+    run_test(_test, test_no_leak);
+    run_test(_test, test_leak);
+    run_test(_test, test_heap_profile);
+    run_test(_test, test_blocked);
+    run_test(_test, test_io_within_budget);
+    run_test(_test, test_io_over_budget);
+    run_test(_test, test_lock_contention);
+    run_test(_test, test_death_abort);
+    run_test(_test, test_death_survives);
+    run_test(_test, test_death_hangs);
+    run_test(_test, test_checks);
+    run_test(_test, test_compare_arrays_float);
+    run_test(_test, test_compare_arrays_double);
+    run_test(_test, test_diff_sequences);
+    run_test(_test, test_random);
+    run_test(_test, test_dataset_cache);
+    _test.run_registered();
+    run_constexpr_test(_test, test_constexpr_count_bits);
+    run_bench(_test, bench_map_lookup);
+    run_bench(_test, bench_random_access_4k);
+    run_bench(_test, bench_random_access_2m);
+    run_bench(_test, bench_sort_batch);
+    run_bench(_test, bench_sort_pause);
+    run_bench(_test, bench_copy_throughput);
+    run_bench(_test, bench_compare_arrays_scalar);
+    run_bench(_test, bench_compare_arrays_sse2);
+    if (test::alg::internal::detected_simd_level() ==
+        test::alg::internal::simd_level::avx2) {
+      run_bench(_test, bench_compare_arrays_avx2);
+    }
+    run_bench(_test, bench_fill_wyrand);
+    run_bench(_test, bench_fill_mt19937);
+    run_bench_family(_test, bench_family_lookup, std::map<int, int>,
+                     std::unordered_map<int, int>);
+    run_tune(_test, bench_tune_block_sum);
+    run_load(_test, bench_load_handler);
+    run_bench(_test, bench_dispatch);
 
   } catch (std::exception &_ex) {
     std::cout << "EXCEPTION: '" << _ex.what() << "'" << std::endl;
@@ -0,0 +1,261 @@
+/// \example
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas rodrigo.canellas@gmail.com
+
+/// \brief Measures how much tenacitas::lib::test::alg::tester costs per test
+///
+/// \details Each benchmark registers '--overhead-tests <n>' (default 10000)
+/// tests with distinct names, and each iteration executes one of them with a
+/// tester configured for one mode, so the nanoseconds per iteration are the
+/// cost of a test in that mode. 'overhead_baseline' executes nothing, and
+/// measures the cost of timing an iteration, which is included in the others.
+/// Comparing two builds with '--ab' shows regressions of the tester:
+///
+/// \code
+/// tenacitas.lib.test.overhead --ab { ./old/tenacitas.lib.test.overhead
+/// ./new/tenacitas.lib.test.overhead } --bench-iterations 100000
+/// \endcode
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <tenacitas.lib.program/alg/options.h>
+#include <tenacitas.lib.test/alg/bench_state.h>
+#include <tenacitas.lib.test/alg/tester.h>
+#include <tenacitas.lib.test/alg/tester_modes.h>
+
+using namespace tenacitas::lib;
+
+struct test_empty {
+  bool operator()(const program::alg::options &) { return true; }
+
+  static constexpr std::string_view desc() { return "does nothing"; }
+};
+
+struct test_tiny {
+  bool operator()(const program::alg::options &) {
+    volatile int _values[64];
+    for (int _i = 0; _i < 64; ++_i) {
+      _values[_i] = _i;
+    }
+    int _sum{0};
+    for (int _i = 0; _i < 64; ++_i) {
+      _sum += _values[_i];
+    }
+    return _sum == 2016;
+  }
+
+  static constexpr std::string_view desc() { return "sums 64 integers"; }
+};
+
+/// \brief Discards what is written to it, so the cost of formatting the
+/// output is measured, but not the cost of writing it
+struct null_buffer : public std::streambuf {
+protected:
+  int overflow(int p_char) override { return p_char; }
+
+  std::streamsize xsputn(const char *, std::streamsize p_size) override {
+    return p_size;
+  }
+};
+
+/// \brief Writes to '/dev/null', so the cost of writing the output is also
+/// measured
+struct dev_null_buffer : public std::filebuf {
+  dev_null_buffer() { open("/dev/null", std::ios_base::out); }
+};
+
+/// \brief Tester that selects the tests from the options, and prints only the
+/// failures
+using selecting_tester =
+    test::alg::tester<test::alg::options_scheduler, test::alg::quiet_reporter,
+                      test::alg::tsc_timer, test::alg::no_instrumentation>;
+
+/// \brief Tester that prints every test, and measures nothing
+using reporting_tester =
+    test::alg::tester<test::alg::options_scheduler,
+                      test::alg::stream_reporter, test::alg::tsc_timer,
+                      test::alg::no_instrumentation>;
+
+/// \brief Executes every test, printing only failures, and measuring nothing
+struct mode_lean {
+  static constexpr std::string_view desc() {
+    return "with 'test::alg::lean_tester'";
+  }
+
+  using tester = test::alg::lean_tester;
+  using buffer = void;
+
+  static std::vector<std::string> args(const std::vector<std::string> &) {
+    return {};
+  }
+};
+
+/// \brief Executes the tests selected with '--exec { ... }', one in every 10
+struct mode_selection {
+  static constexpr std::string_view desc() {
+    return "selecting one in 10 tests from '--exec'";
+  }
+
+  using tester = selecting_tester;
+  using buffer = void;
+
+  static std::vector<std::string>
+  args(const std::vector<std::string> &p_names) {
+    std::vector<std::string> _args{"--exec", "{"};
+    for (std::size_t _i = 0; _i < p_names.size(); _i += 10) {
+      _args.push_back(p_names[_i]);
+    }
+    _args.push_back("}");
+    return _args;
+  }
+};
+
+/// \brief Executes every test, formatting the output, but discarding it
+struct mode_reporting {
+  static constexpr std::string_view desc() {
+    return "formatting the output";
+  }
+
+  using tester = reporting_tester;
+  using buffer = null_buffer;
+
+  static std::vector<std::string> args(const std::vector<std::string> &) {
+    return {"--exec"};
+  }
+};
+
+/// \brief Executes every test, writing the output to '/dev/null'
+struct mode_output {
+  static constexpr std::string_view desc() {
+    return "writing the output to '/dev/null'";
+  }
+
+  using tester = reporting_tester;
+  using buffer = dev_null_buffer;
+
+  static std::vector<std::string> args(const std::vector<std::string> &) {
+    return {"--exec"};
+  }
+};
+
+/// \brief Executes every test with the default tester, which measures the
+/// time and I/O of each test, discarding the output
+struct mode_instrumentation {
+  static constexpr std::string_view desc() {
+    return "with the default tester";
+  }
+
+  using tester = test::alg::tester<>;
+  using buffer = null_buffer;
+
+  static std::vector<std::string> args(const std::vector<std::string> &) {
+    return {"--exec"};
+  }
+};
+
+/// \brief Executes, in each iteration, one of the registered tests with a
+/// tester configured by \p t_mode
+///
+/// \tparam t_mode defines the type of the tester, the arguments passed to it,
+/// and where 'std::cout' and 'std::cerr' are redirected
+///
+/// \tparam t_test is the test executed
+template <typename t_mode, typename t_test> struct overhead {
+  void operator()(test::alg::bench_state &p_state) {
+    if (!m_tester) {
+      p_state.pause_timing();
+      create(p_state.options());
+      p_state.resume_timing();
+    }
+    const std::string &_name{m_names[p_state.iteration() % m_names.size()]};
+    if constexpr (std::is_void_v<typename t_mode::buffer>) {
+      m_tester->template run<t_test>(_name);
+    } else {
+      std::streambuf *_cout{std::cout.rdbuf(m_buffer.get())};
+      std::streambuf *_cerr{std::cerr.rdbuf(m_buffer.get())};
+      m_tester->template run<t_test>(_name);
+      std::cout.rdbuf(_cout);
+      std::cerr.rdbuf(_cerr);
+    }
+  }
+
+  static std::string desc() {
+    return "executes a test that " + std::string{t_test::desc()} + ", " +
+           std::string{t_mode::desc()};
+  }
+
+private:
+  void create(const program::alg::options &p_options) {
+    std::size_t _tests{10000};
+    std::optional<program::alg::options::value> _maybe_tests{
+        p_options.get_single_param("overhead-tests")};
+    if (_maybe_tests) {
+      _tests = std::stoul(*_maybe_tests);
+    }
+    for (std::size_t _i = 0; _i < _tests; ++_i) {
+      m_names.push_back("test_" + std::to_string(_i));
+    }
+
+    m_args = t_mode::args(m_names);
+    m_args.insert(m_args.begin(), "overhead");
+    for (std::string &_arg : m_args) {
+      m_argv.push_back(_arg.data());
+    }
+    m_argv.push_back(nullptr);
+
+    if constexpr (!std::is_void_v<typename t_mode::buffer>) {
+      m_buffer = std::make_unique<typename t_mode::buffer>();
+    }
+    m_tester = std::make_unique<typename t_mode::tester>(
+        static_cast<int>(m_args.size()), m_argv.data());
+  }
+
+private:
+  std::vector<std::string> m_names;
+  std::vector<std::string> m_args;
+  std::vector<char *> m_argv;
+  std::unique_ptr<std::streambuf> m_buffer;
+  std::unique_ptr<typename t_mode::tester> m_tester;
+};
+
+struct overhead_baseline {
+  void operator()(test::alg::bench_state &) {}
+
+  static std::string desc() {
+    return "executes nothing, measuring the cost of timing an iteration";
+  }
+};
+
+using overhead_lean_empty = overhead<mode_lean, test_empty>;
+using overhead_lean_tiny = overhead<mode_lean, test_tiny>;
+using overhead_selection = overhead<mode_selection, test_empty>;
+using overhead_reporting = overhead<mode_reporting, test_empty>;
+using overhead_output = overhead<mode_output, test_empty>;
+using overhead_instrumentation = overhead<mode_instrumentation, test_empty>;
+
+int main(int argc, char **argv) {
+  try {
+    test::alg::tester _test(argc, argv);
+    run_bench(_test, overhead_baseline);
+    run_bench(_test, overhead_lean_empty);
+    run_bench(_test, overhead_lean_tiny);
+    run_bench(_test, overhead_selection);
+    run_bench(_test, overhead_reporting);
+    run_bench(_test, overhead_output);
+    run_bench(_test, overhead_instrumentation);
+  } catch (std::exception &_ex) {
+    std::cout << "EXCEPTION: '" << _ex.what() << "'" << std::endl;
+  }
+}
@@ -0,0 +1,43 @@
+/// \example
+
+/// \copyright This file is under GPL 3 license. Please read the \p LICENSE file
+/// at the root of \p tenacitas directory
+
+/// \author Rodrigo Canellas rodrigo.canellas@gmail.com
+
+/// \brief Tests registered in a translation unit that does not include
+/// tenacitas.lib.test/alg/tester.h, executed by 'run_registered' in main.cpp
+
+#include <array>
+#include <numeric>
+#include <string_view>
+
+#include <tenacitas.lib.test/alg/registry.h>
+
+using namespace tenacitas::lib;
+
+struct test_registered_sum {
+  bool operator()(const program::alg::options &) {
+    std::array<int, 100> _values;
+    std::iota(_values.begin(), _values.end(), 1);
+    return std::accumulate(_values.begin(), _values.end(), 0) == 5050;
+  }
+
+  static constexpr std::string_view desc() {
+    return "sums 1 to 100, registered in a translation unit that does not "
+           "include 'tester.h'";
+  }
+};
+
+struct test_registered_budget {
+  bool operator()(const program::alg::options &) { return true; }
+
+  static constexpr std::size_t max_wchar{0};
+
+  static constexpr std::string_view desc() {
+    return "does no I/O, with a 'max_wchar' of 0";
+  }
+};
+
+register_test(test_registered_sum);
+register_test(test_registered_budget);